@@ -0,0 +1,7 @@
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    mat4 orthographic; // Screen space in pixels
+    vec4 viewport; // Width, height, 1 / width, 1 / height
+    float time; // Song time in s
+};
\ No newline at end of file
@@ -1,9 +1,9 @@
 #version 330 core
 
-out vec4 out_color;
+in vec4 tint;
 
-uniform vec3 color;
+out vec4 out_color;
 
 void main() {
-    out_color = vec4(color, 1.0);
+    out_color = tint;
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+
+// Per instance
+layout (location = 1) in vec3 offset;
+layout (location = 2) in vec3 scale;
+layout (location = 3) in vec4 color;
+layout (location = 4) in uint flags;
+
+#include "frame.glsl"
+
+out vec4 tint;
+
+void main() {
+    tint = color;
+
+    // Hidden instances collapse to a degenerate triangle and never reach the rasterizer
+    if ((flags & 1u) == 0u) {
+        gl_Position = vec4(0.0);
+        return;
+    }
+
+    gl_Position = projection * view * vec4(offset + position * scale, 1.0);
+}
\ No newline at end of file
@@ -1,9 +0,0 @@
-#version 330 core
-
-out vec4 frag;
-
-uniform vec3 color;
-
-void main() {
-    frag = vec4(color, 1.0);
-}
\ No newline at end of file
@@ -0,0 +1,93 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+
+#include <GLFW/glfw3.h>
+
+#include "sound.h"
+
+// Song position slaved to the playing sound. The audio position only advances once per mixed device period, so
+// gameplay reads the monotonic clock shifted by an origin that is pulled towards the audio position every update.
+// update() belongs to one thread, song_time() can be read from any.
+class Clock {
+private:
+    // Time constant of the correction in s, and the error beyond which the origin jumps instead
+    static constexpr double SMOOTHING = 0.25, SNAP = 0.1;
+
+    Sound &sound;
+
+    std::atomic<double> origin = 0; // Monotonic time of song time 0
+    double updated = 0;
+    bool synced = false;
+
+    uint64_t samples = 0;
+    double sum = 0, squares = 0, worst = 0, last = 0;
+
+public:
+    explicit Clock(Sound &sound) : sound(sound) {}
+
+    /**
+     * Compare the audio position with the song time and move the origin towards it. The correction depends on the
+     * time since the last call, not on how often it is called.
+     */
+    void update() {
+        double now = glfwGetTime(), audio = sound.position();
+        double elapsed = now - updated;
+        updated = now;
+
+        // Before the first sample is out, and after the sound ends, the audio position stands still
+        if (!synced || !sound.playing() || audio == 0) {
+            origin = now - audio;
+            synced = sound.playing() && audio > 0;
+            return;
+        }
+
+        double error = audio - (now - origin);
+        last = error;
+        samples++, sum += error, squares += error * error;
+        worst = std::max(worst, std::abs(error));
+
+        origin = origin - (std::abs(error) > SNAP ? error : error * std::min(elapsed / SMOOTHING, 1.0));
+    }
+
+    /**
+     * @return Current position in the song in s
+     */
+    [[nodiscard]] double song_time() const {
+        return glfwGetTime() - origin;
+    }
+
+    /**
+     * @return Position in the song at a glfwGetTime() timestamp, such as the one of an input event
+     */
+    [[nodiscard]] double song_time(double timestamp) const {
+        return timestamp - origin;
+    }
+
+    /**
+     * @return Audio position minus song time at the last update in s
+     */
+    [[nodiscard]] double error() const {
+        return last;
+    }
+
+    void report(std::ostream &out) const {
+        double mean = samples ? sum / double(samples) : 0;
+        double deviation = samples ? std::sqrt(std::max(squares / double(samples) - mean * mean, 0.0)) : 0;
+        out << "Audio sync error: mean " << mean * 1000 << " ms, deviation " << deviation * 1000
+            << " ms, max " << worst * 1000 << " ms over " << samples << " updates\n";
+    }
+};
+
+#endif // CLOCK_H
@@ -7,27 +7,104 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <AL/al.h>
 #include <AL/alc.h>
+#include <AL/alext.h>
 
+#include "../utils/riff.h"
 #include "../utils/wav.h"
 
 class Sound {
 private:
+    // Streaming ring, 4 x 32 KiB is about 0.75 s of 44.1 kHz stereo 16-bit audio
+    static constexpr int STREAM_BUFFERS = 4;
+    static constexpr std::size_t STREAM_BUFFER_SIZE = 1 << 15;
+
     unsigned int buffer = 0, source = 0;
-    bool stopped = true;
+    std::atomic<bool> stopped = true;
 
     std::string path;
 
-    inline ALenum to_al_format(int8_t channels, int8_t samples) {
-        bool stereo = (channels > 1);
+    bool streaming = false, loops = false;
+    unsigned int buffers[STREAM_BUFFERS] = {};
+    uint32_t buffer_frames[STREAM_BUFFERS] = {}; // Frames last uploaded to each stream buffer
+    std::vector<unsigned int> idle;
+    uint64_t played = 0; // Frames of the stream buffers already unqueued since the last rewind
+
+    std::ifstream input;
+    Riff::Chunk chunk;
+    uint64_t cursor = 0;
+    std::vector<char> block;
+
+    ALenum format = AL_NONE;
+    PCM::Encoding encoding = PCM::Encoding::INT16, uploaded = PCM::Encoding::INT16; // Samples of the file and of AL
+    std::vector<uint8_t> converted;
+    int sample_rate = 0;
+    uint64_t total = 0; // Frames in the whole file
+    std::size_t block_align = 0; // Bytes per frame
+    LPALGETSOURCEDVSOFT get_source_latency = nullptr;
+    bool finished = false;
+
+    std::mutex lock;
+    std::atomic<bool> running = false;
+    std::thread worker;
+
+    // Pick the AL format of a file. Samples OpenAL takes as they are are uploaded directly, wider ones are converted
+    // to float when AL_EXT_float32 is available and to 16-bit otherwise.
+    void choose_format(const Audio::Format &wav) {
+        if (wav.channels > 2) {
+            throw std::runtime_error("Unsupported channel count " + std::to_string(wav.channels) + " in " + path);
+        }
+        bool stereo = wav.channels == 2;
+
+        encoding = wav.encoding;
+        sample_rate = (int) wav.sample_rate;
+        block_align = wav.block_align;
 
-        if (samples == 8) return stereo ? AL_FORMAT_STEREO8 : AL_FORMAT_MONO8;
-        if (samples == 16) return stereo ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
-        return -1;
+        if (encoding == PCM::Encoding::UINT8 || encoding == PCM::Encoding::INT16) {
+            uploaded = encoding;
+        } else if (alIsExtensionPresent("AL_EXT_float32")) {
+            uploaded = PCM::Encoding::FLOAT32;
+        } else {
+            uploaded = PCM::Encoding::INT16;
+        }
+
+        switch (uploaded) {
+            case PCM::Encoding::UINT8:
+                format = stereo ? AL_FORMAT_STEREO8 : AL_FORMAT_MONO8;
+                break;
+            case PCM::Encoding::FLOAT32:
+                format = stereo ? AL_FORMAT_STEREO_FLOAT32 : AL_FORMAT_MONO_FLOAT32;
+                break;
+            default:
+                format = stereo ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+                break;
+        }
+    }
+
+    // Upload whole frames of the file to an AL buffer, converting them first if AL can't take them
+    void upload(unsigned int target, const char *data, std::size_t size) {
+        if (encoding != uploaded) {
+            std::size_t from = PCM::bytes(encoding), to = PCM::bytes(uploaded), samples = size / from;
+            converted.resize(samples * to);
+            auto *src = (const uint8_t *) data;
+            for (std::size_t i = 0; i < samples; i++) {
+                PCM::encode(PCM::decode(src + i * from, encoding), uploaded, converted.data() + i * to);
+            }
+            data = (const char *) converted.data(), size = converted.size();
+        }
+        alBufferData(target, format, data, (ALsizei) size, sample_rate);
     }
 
     inline void fail(const std::string &message) {
@@ -37,59 +114,187 @@ private:
         }
     }
 
+    // Decode the next block of the data chunk into an AL buffer, wrapping around for looping sounds
+    bool fill(unsigned int target) {
+        if (cursor == chunk.size && loops) cursor = 0;
+        if (cursor == chunk.size) {
+            finished = true;
+            return false;
+        }
+
+        auto size = (std::size_t) std::min<uint64_t>(block.size(), chunk.size - cursor);
+        input.clear();
+        input.seekg((std::streamoff) (chunk.offset + cursor));
+        input.read(block.data(), (std::streamsize) size);
+        cursor += size;
+
+        upload(target, block.data(), size);
+        fail("Stream Buffer Data");
+        buffer_frames[std::find(buffers, buffers + STREAM_BUFFERS, target) - buffers] = uint32_t(size / block_align);
+        alSourceQueueBuffers(source, 1, &target);
+        return true;
+    }
+
+    // Refill processed buffers until the thread is told to stop
+    void pump() {
+        while (running) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+
+                int processed = 0;
+                alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+                while (processed-- > 0) {
+                    unsigned int done;
+                    alSourceUnqueueBuffers(source, 1, &done);
+                    idle.push_back(done);
+                    played += buffer_frames[std::find(buffers, buffers + STREAM_BUFFERS, done) - buffers];
+                }
+
+                while (!idle.empty() && fill(idle.back())) idle.pop_back();
+
+                // Restart after an underrun, the source stops on its own once the queue runs dry
+                int state = 0, queued = 0;
+                alGetSourcei(source, AL_SOURCE_STATE, &state);
+                alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+                if (!stopped && state == AL_STOPPED && queued > 0 && !finished) alSourcePlay(source);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    // Drop everything that is queued and prime the first buffer from the beginning of the data chunk
+    void rewind() {
+        alSourceStop(source);
+        alSourcei(source, AL_BUFFER, 0);
+
+        idle.assign(buffers, buffers + STREAM_BUFFERS);
+        cursor = 0, played = 0;
+        finished = false;
+
+        if (fill(idle.back())) idle.pop_back();
+    }
+
 public:
     Sound() = default;
 
-    Sound(const std::string &path, bool loops = true) : path(path) {
+    /**
+     * @param stream Decode the file while it plays through a small ring of queued buffers instead of uploading it at once
+     */
+    Sound(const std::string &path, bool loops = true, bool stream = false) : path(path), streaming(stream), loops(loops) {
         alGenSources(1, &source);
         alSourcef(source, AL_PITCH, 1);
         alSourcef(source, AL_GAIN, 1);
         alSource3f(source, AL_POSITION, 0, 0, 0);
         alSource3f(source, AL_VELOCITY, 0, 0, 0);
-        alSourcei(source, AL_LOOPING, (loops ? AL_TRUE : AL_FALSE));
+        alSourcei(source, AL_LOOPING, (loops && !streaming ? AL_TRUE : AL_FALSE));
 
-        alGenBuffers(1, &buffer);
+        if (alIsExtensionPresent("AL_SOFT_source_latency")) {
+            get_source_latency = (LPALGETSOURCEDVSOFT) alGetProcAddress("alGetSourcedvSOFT");
+        }
 
-        int channels, sampleRate, bps, size;
-        char *data = Audio::load(path, channels, sampleRate, bps, size);
+        if (streaming) {
+            input.open(path, std::ios::binary);
+            if (!input) {
+                throw std::runtime_error("Can't open the file " + path);
+            }
+            Riff::Index index = Riff::parse(input);
+            choose_format(Audio::read_format(input, index));
+            chunk = index.data;
+            chunk.size = uint32_t(chunk.size / block_align * block_align);
 
-        alBufferData(buffer, to_al_format(channels, bps), data, size, sampleRate);
+            total = chunk.size / block_align;
+            block.resize(STREAM_BUFFER_SIZE / block_align * block_align);
+
+            alGenBuffers(STREAM_BUFFERS, buffers);
+            rewind();
+
+            running = true;
+            worker = std::thread(&Sound::pump, this);
+            return;
+        }
+
+        Audio::Format wav;
+        std::vector<char> data = Audio::load(path, wav);
+        choose_format(wav);
+
+        alGenBuffers(1, &buffer);
+
+        upload(buffer, data.data(), data.size());
+        total = data.size() / block_align;
+        std::vector<uint8_t>().swap(converted);
 
         fail("Buffer Data");
 
         alSourcei(source, AL_BUFFER, buffer);
     }
 
+    Sound(const Sound &) = delete;
+
+    Sound &operator=(const Sound &) = delete;
+
     ~Sound() {
+        running = false;
+        if (worker.joinable()) worker.join();
+
         alDeleteSources(1, &source);
-        alDeleteBuffers(1, &buffer);
+        if (streaming) alDeleteBuffers(STREAM_BUFFERS, buffers);
+        else alDeleteBuffers(1, &buffer);
     }
 
     void play() {
+        std::lock_guard<std::mutex> guard(lock);
+
         int state = 0;
         alGetSourcei(source, AL_SOURCE_STATE, &state);
         if (state == AL_STOPPED) {
+            // Playing a stopped source starts over, a stream has to be decoded from the beginning again
+            if (streaming) rewind();
+            alSourcePlay(source);
             stopped = false;
-            alSourcei(source, AL_POSITION, 0);
-        }
-
-        if (stopped) {
+        } else if (stopped) {
             alSourcePlay(source);
             stopped = false;
         }
     }
 
     void stop() {
+        std::lock_guard<std::mutex> guard(lock);
+
         if (!stopped) {
             alSourceStop(source);
             stopped = true;
         }
     }
 
+    /**
+     * @return Position of the sample being heard in seconds, the output latency is subtracted when the device
+     * reports it through AL_SOFT_source_latency
+     */
+    double position() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (sample_rate == 0) return 0;
+
+        // Offsets are relative to the first buffer still queued, everything unqueued before it has been played
+        double offset[2] = {0, 0};
+        if (get_source_latency) {
+            get_source_latency(source, AL_SEC_OFFSET_LATENCY_SOFT, offset);
+        } else {
+            int sample = 0;
+            alGetSourcei(source, AL_SAMPLE_OFFSET, &sample);
+            offset[0] = double(sample) / sample_rate;
+        }
+
+        double result = double(played) / sample_rate + offset[0] - offset[1];
+        if (loops && total > 0) result = std::fmod(result, double(total) / sample_rate);
+        return std::max(result, 0.0);
+    }
+
     bool playing() {
+        std::lock_guard<std::mutex> guard(lock);
+
         int state = -1;
         alGetSourcei(source, AL_SOURCE_STATE, &state);
-        if (state == AL_STOPPED) stopped = true;
+        if (state == AL_STOPPED && (!streaming || finished)) stopped = true;
         return !stopped;
     }
 };
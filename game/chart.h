@@ -0,0 +1,127 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef CHART_H
+#define CHART_H
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../utils/onset.h"
+#include "../utils/random.h"
+#include "../utils/tempo.h"
+#include "../utils/wav.h"
+
+enum class NoteType : uint8_t {
+    TAP
+};
+
+// Notes of a song, sorted by time and then lane, stored as structure of arrays
+class Chart {
+public:
+    static constexpr int LANES = 4;
+
+    std::vector<double> times; // Time the note reaches the judgement line in s
+    std::vector<uint8_t> lanes;
+    std::vector<NoteType> types;
+
+    // Indices of the notes of each lane, ascending in time
+    std::vector<uint32_t> lane_notes[LANES];
+
+    Beats beats;
+
+    Chart() = default;
+
+    /**
+     * Chart of the onsets of a song, snapped to the beat grid. The strongest onset on a grid point decides how
+     * many lanes it occupies and the lanes are drawn from a generator seeded with seed.
+     * @param subdivision Grid points per beat
+     * @param lead_in Time at the beginning of the song without notes in s
+     */
+    static Chart generate(const Audio &audio, uint32_t seed, int subdivision = 2, double lead_in = 2.0) {
+        static const std::vector<std::vector<int>> permutation[LANES + 1] = {
+                {},
+                {{0},       {1},       {2},       {3}},
+                {{0, 1},    {0, 2},    {0, 3},    {1, 2}, {1, 3}, {2, 3}},
+                {{0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3}},
+                {{0, 1, 2, 3}}
+        };
+
+        Chart chart;
+        Onsets onsets = OnsetDetector().detect(audio);
+        chart.beats = TempoEstimator().estimate(onsets);
+
+        std::vector<std::pair<double, int>> points;
+        for (auto &onset: onsets.onsets) {
+            double time = chart.beats.quantize(onset.time, subdivision);
+            int count = std::min(1 + int(onset.strength * LANES), LANES);
+            if (time < lead_in) continue;
+            if (!points.empty() && std::abs(points.back().first - time) < 1e-6) {
+                points.back().second = std::max(points.back().second, count);
+            } else points.emplace_back(time, count);
+        }
+
+        Random<int> random(0, 23, seed);
+        for (auto &[time, count]: points) {
+            for (int lane: permutation[count][random() % permutation[count].size()]) chart.add(time, lane);
+        }
+        return chart;
+    }
+
+    /**
+     * Insert a note, keeping the arrays sorted. Appending in time order is constant time.
+     */
+    void add(double time, int lane, NoteType type = NoteType::TAP) {
+        std::size_t index = times.size();
+        while (index > 0 && (times[index - 1] > time || (times[index - 1] == time && lanes[index - 1] > lane))) index--;
+
+        if (index < times.size()) {
+            for (auto &notes: lane_notes) {
+                for (auto &note: notes) if (note >= index) note++;
+            }
+        }
+
+        times.insert(times.begin() + (std::ptrdiff_t) index, time);
+        lanes.insert(lanes.begin() + (std::ptrdiff_t) index, (uint8_t) lane);
+        types.insert(types.begin() + (std::ptrdiff_t) index, type);
+
+        auto &notes = lane_notes[lane];
+        notes.insert(std::upper_bound(notes.begin(), notes.end(), (uint32_t) index), (uint32_t) index);
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return times.size();
+    }
+
+    /**
+     * @return Index of the first note at or after time
+     */
+    [[nodiscard]] std::size_t seek(double time) const {
+        return std::lower_bound(times.begin(), times.end(), time) - times.begin();
+    }
+
+    /**
+     * @return Position in lane_notes[lane] of the first note of the lane at or after time
+     */
+    [[nodiscard]] std::size_t seek(int lane, double time) const {
+        auto &notes = lane_notes[lane];
+        return std::partition_point(notes.begin(), notes.end(), [&](uint32_t note) {
+            return times[note] < time;
+        }) - notes.begin();
+    }
+
+    /**
+     * @return Range of the indices of the notes in [begin, end)
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> window(double begin, double end) const {
+        return {seek(begin), seek(end)};
+    }
+};
+
+#endif // CHART_H
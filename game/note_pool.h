@@ -0,0 +1,188 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef NOTE_POOL_H
+#define NOTE_POOL_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "chart.h"
+
+#include "../utils/aligned.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define NOTE_POOL_X86 1
+#else
+#define NOTE_POOL_X86 0
+#endif
+
+enum class NoteState : uint8_t {
+    PENDING, HIT
+};
+
+// Notes on screen, stored as structure of arrays. Notes are spawned in chart order and retire in time order, so the
+// live ones are always the contiguous slots [begin(), end()) and the chart index of a slot is known from its offset.
+class NotePool {
+private:
+    std::size_t capacity = 0, head = 0, tail = 0;
+    uint32_t first = 0; // Chart index of the note in slot head
+
+    static void scalar_scroll(const float *time, float *x, std::size_t count, float now, float scale) {
+        for (std::size_t i = 0; i < count; i++) {
+            float left = time[i] - now;
+            x[i] = scale * left * left;
+        }
+    }
+
+#if NOTE_POOL_X86
+    __attribute__((target("avx2")))
+    static void avx2_scroll(const float *time, float *x, std::size_t count, float now, float scale) {
+        __m256 current = _mm256_set1_ps(now), factor = _mm256_set1_ps(scale);
+        for (std::size_t i = 0; i < count; i += 8) {
+            __m256 left = _mm256_sub_ps(_mm256_load_ps(time + i), current);
+            _mm256_store_ps(x + i, _mm256_mul_ps(factor, _mm256_mul_ps(left, left)));
+        }
+    }
+#endif
+
+    // Move the live slots back to the start once the tail runs out of room
+    void compact() {
+        std::size_t count = size();
+        std::copy(time.begin() + (std::ptrdiff_t) head, time.begin() + (std::ptrdiff_t) tail, time.begin());
+        std::copy(z.begin() + (std::ptrdiff_t) head, z.begin() + (std::ptrdiff_t) tail, z.begin());
+        std::copy(color.begin() + (std::ptrdiff_t) head, color.begin() + (std::ptrdiff_t) tail, color.begin());
+        std::copy(state.begin() + (std::ptrdiff_t) head, state.begin() + (std::ptrdiff_t) tail, state.begin());
+        std::copy(lane.begin() + (std::ptrdiff_t) head, lane.begin() + (std::ptrdiff_t) tail, lane.begin());
+        head = 0, tail = count;
+    }
+
+    // Double the capacity keeping the live notes, only needed when the density the pool was reserved for is exceeded
+    void grow() {
+        compact();
+        capacity = std::max<std::size_t>(2 * capacity, 1);
+        std::size_t slots = aligned_size<float>(2 * capacity);
+        time.resize(slots, 0.0f), x.resize(slots, 0.0f), z.resize(slots, 0.0f);
+        color.resize(slots, glm::vec3(0));
+        state.resize(slots, NoteState::PENDING);
+        lane.resize(slots, 0);
+    }
+
+public:
+    // Arrival time in song time, scroll position, lane offset and color of every slot
+    aligned_vector<float> time, x, z;
+    std::vector<glm::vec3> color;
+    std::vector<NoteState> state;
+    std::vector<uint8_t> lane;
+
+    NotePool() = default;
+
+    explicit NotePool(std::size_t capacity) {
+        reserve(capacity);
+    }
+
+    /**
+     * @return Largest number of notes of the chart arriving within any span of the given length
+     */
+    static std::size_t density(const Chart &chart, double span) {
+        std::size_t result = 0;
+        for (std::size_t begin = 0, end = 0; end < chart.size(); end++) {
+            while (chart.times[end] - chart.times[begin] > span) begin++;
+            result = std::max(result, end - begin + 1);
+        }
+        return result;
+    }
+
+    void reserve(std::size_t count) {
+        // Twice the capacity so that compaction happens at most once every capacity spawns, rounded up to whole
+        // vectors so that the scroll kernel never needs a tail loop
+        capacity = std::max<std::size_t>(count, 1);
+        std::size_t slots = aligned_size<float>(2 * capacity);
+        time.assign(slots, 0.0f), x.assign(slots, 0.0f), z.assign(slots, 0.0f);
+        color.assign(slots, glm::vec3(0));
+        state.assign(slots, NoteState::PENDING);
+        lane.assign(slots, 0);
+        head = tail = 0, first = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return tail - head;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return head == tail;
+    }
+
+    [[nodiscard]] std::size_t begin() const {
+        return head;
+    }
+
+    [[nodiscard]] std::size_t end() const {
+        return tail;
+    }
+
+    /**
+     * @return Chart index of the oldest live note
+     */
+    [[nodiscard]] uint32_t front() const {
+        return first;
+    }
+
+    /**
+     * @return Slot of a live note from its chart index
+     */
+    [[nodiscard]] std::size_t slot(uint32_t note) const {
+        return head + (note - first);
+    }
+
+    /**
+     * Add the next note of the chart. Notes have to be spawned in chart order.
+     */
+    std::size_t spawn(const Chart &chart, uint32_t note, const glm::vec3 &tint) {
+        if (size() == capacity) grow();
+        if (tail == 2 * capacity) compact();
+        if (empty()) first = note;
+
+        std::size_t i = tail++;
+        time[i] = (float) chart.times[note];
+        z[i] = -0.075f + 0.05f * (float) chart.lanes[note];
+        color[i] = tint;
+        state[i] = NoteState::PENDING;
+        lane[i] = chart.lanes[note];
+        return i;
+    }
+
+    /**
+     * Drop the oldest live note
+     */
+    void pop() {
+        head++, first++;
+        if (empty()) head = tail = 0;
+    }
+
+    /**
+     * x = scale (time - now)^2 for every live slot
+     */
+    void scroll(float now, float scale) {
+        constexpr std::size_t step = aligned_size<float>(1);
+        std::size_t begin = head / step * step;
+        std::size_t count = aligned_size<float>(tail - begin);
+#if NOTE_POOL_X86
+        static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+        if (avx2) {
+            avx2_scroll(time.data() + begin, x.data() + begin, count, now, scale);
+            return;
+        }
+#endif
+        scalar_scroll(time.data() + begin, x.data() + begin, count, now, scale);
+    }
+};
+
+#endif // NOTE_POOL_H
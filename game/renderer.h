@@ -0,0 +1,115 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "game.h"
+
+#include "../graphics/gui/font/font.h"
+#include "../graphics/gui/font/text.h"
+#include "../graphics/hint.h"
+#include "../graphics/instance.h"
+#include "../graphics/line.h"
+#include "../graphics/meshes.h"
+#include "../graphics/shader.h"
+#include "../graphics/tile.h"
+#include "../graphics/uniform_buffer.h"
+
+extern const int32_t width, height;
+
+// GL side of the game, created and used only on the thread that owns the context
+class Renderer {
+private:
+    Shader text_shader = Shader("font.vert", "font.frag");
+    Shader instance_shader = Shader("instance.vert", "instance.frag");
+
+    Font font = Font("Jetbrains.ttf");
+    Text score_label = Text(font, "Score", glm::vec2(5.0f, height - 40.0f), 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+    Text score = Text(font, 11, glm::vec2(180.0f, height - 40.0f), 1.0f, glm::vec3(0.5f, 0.5f, 1.0f));
+
+    // Per frame data of every shader, the camera can move by changing it before the upload
+    FrameUniforms camera;
+    UniformBuffer<FrameUniforms> frame = UniformBuffer<FrameUniforms>(UniformBlock::FRAME);
+
+    Meshes meshes;
+    Mesh cube = meshes.cube(), segment = meshes.segment();
+
+    std::vector<Line> lines;
+    std::vector<Hint> hints;
+
+    // Instances of every object, refilled each frame except for the lines that never move
+    std::vector<Instance> batch;
+    InstanceBuffer line_instances, hint_instances, tile_instances;
+
+public:
+    Renderer() {
+        for (int i = -2; i <= 2; i++) {
+            lines.push_back({glm::vec3(-2, 0, i * 0.05), glm::vec3(200, 0, i * 0.05), glm::vec3(1, 1, 1)});
+        }
+        lines.push_back({glm::vec3(0, 0, -5), glm::vec3(0, 0, 5), glm::vec3(1, 0, 1)});
+
+        for (auto &line: lines) batch.push_back(line.instance());
+        line_instances.upload(batch);
+
+        hints.resize(Chart::LANES);
+        for (int i = 0; i < Chart::LANES; i++) hints[i].position.z = -0.075f + 0.05f * (float) i;
+
+        camera.projection = glm::perspective(glm::radians(0.5f), (float) width / (float) height, 0.1f, 200.0f);
+        camera.view = glm::lookAt(glm::vec3(-15, 0.05, 0), glm::vec3(200, -0.05, 0), glm::vec3(0, 1.f, 0.f));
+        camera.orthographic = glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
+        camera.viewport = glm::vec4(width, height, 1.0f / (float) width, 1.0f / (float) height);
+    }
+
+    /**
+     * Draw a snapshot with tiles placed at a song time between it and the next update
+     */
+    void render(Snapshot &snapshot, double time) {
+        camera.time = (float) time;
+        frame.update(camera);
+
+        NotePool &notes = snapshot.notes;
+        notes.scroll((float) time, float(200.0 / (Game::TRAVEL * Game::TRAVEL)));
+
+        batch.clear();
+        for (int i = 0; i < Chart::LANES; i++) {
+            hints[i].show = snapshot.pressed[i];
+            batch.push_back(hints[i].instance());
+        }
+        hint_instances.upload(batch);
+
+        batch.clear();
+        for (std::size_t slot = notes.begin(); slot < notes.end(); slot++) {
+            batch.push_back(Tile{glm::vec3(notes.x[slot], 0, notes.z[slot]), notes.color[slot]}.instance());
+        }
+        tile_instances.upload(batch);
+
+        glDisable(GL_DEPTH_TEST);
+        score.set(snapshot.score);
+        font.draw(text_shader);
+        glEnable(GL_DEPTH_TEST);
+        instance_shader.enable();
+        meshes[segment].draw(line_instances, lines.size());
+        meshes[cube].draw(tile_instances, notes.size());
+        meshes[cube].draw(hint_instances, hints.size());
+        instance_shader.disable();
+    }
+
+    void clear() {
+        line_instances.clear(), hint_instances.clear(), tile_instances.clear();
+        meshes.clear();
+        font.clear();
+        frame.clear();
+    }
+};
+
+#endif // RENDERER_H
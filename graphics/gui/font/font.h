@@ -7,9 +7,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <iostream>
-#include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -23,22 +27,91 @@
 
 #include "../../shader.h"
 
+// Vertex of a glyph quad, the color is per vertex so that strings of any color share one draw call
+struct TextVertex {
+    glm::vec2 position = glm::vec2(0);
+    glm::vec2 uv = glm::vec2(0);
+    glm::vec3 color = glm::vec3(0);
+};
+
 // Credit https://learnopengl.com/In-Practice/Text-Rendering
+// Every ASCII glyph is packed into a single atlas texture. Strings added during a frame are laid out into one vertex
+// buffer and drawn together with a single call. Text objects keep their glyphs in a second, retained buffer that is
+// only written when their contents change.
 class Font {
 private:
-    struct Character {
-        unsigned int ID;
-        glm::ivec2 size;
-        glm::ivec2 bearing;
-        unsigned int advance;
+    static constexpr int GLYPHS = 128, ATLAS_WIDTH = 1024, PADDING = 1;
+
+    struct Glyph {
+        glm::vec2 uv_min = glm::vec2(0), uv_max = glm::vec2(0); // Top left and bottom right in the atlas
+        glm::ivec2 size = glm::ivec2(0);
+        glm::ivec2 bearing = glm::ivec2(0);
+        int advance = 0; // In pixels
     };
 
-    unsigned int vao = 0, vbo = 0;
+    std::array<Glyph, GLYPHS> glyphs{};
+    // Horizontal adjustment in pixels between every pair of glyphs, empty if the face has no kerning
+    std::vector<int> kerning;
 
-public:
-    std::map<char, Character> characters;
+    unsigned int atlas = 0, vao = 0, vbo = 0;
+    std::size_t capacity = 0;
+
+    // Quads of the strings added since the last draw
+    std::vector<TextVertex> vertices;
+
+    // Ranges of the Text objects, 6 vertices per glyph. The buffer is uploaded whole only after a range is added.
+    unsigned int retained_vao = 0, retained_vbo = 0;
+    std::vector<TextVertex> retained;
+    bool resized = false;
+
+    static void createBuffer(unsigned int &vao, unsigned int &vbo) {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        // Position and uv are read together as one vec4
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *) offsetof(TextVertex, position));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *) offsetof(TextVertex, color));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    /**
+     * Write the quads of at most glyphs characters of a string to out
+     * @return Number of vertices written
+     */
+    std::size_t layout(std::string_view text, std::size_t glyphs_max, float x, float y, float scale, glm::vec3 color,
+                       TextVertex *out) const {
+        TextVertex *begin = out;
+        int previous = -1;
+        for (char c: text.substr(0, glyphs_max)) {
+            int index = (unsigned char) c < GLYPHS ? (unsigned char) c : '?';
+            const Glyph &glyph = glyphs[index];
+
+            if (previous >= 0 && !kerning.empty()) x += (float) kerning[previous * GLYPHS + index] * scale;
+            previous = index;
+
+            float left = x + (float) glyph.bearing.x * scale;
+            float bottom = y - (float) (glyph.size.y - glyph.bearing.y) * scale;
+            float right = left + (float) glyph.size.x * scale;
+            float top = bottom + (float) glyph.size.y * scale;
+
+            TextVertex top_left{{left, top}, glyph.uv_min, color};
+            TextVertex bottom_left{{left, bottom}, {glyph.uv_min.x, glyph.uv_max.y}, color};
+            TextVertex bottom_right{{right, bottom}, glyph.uv_max, color};
+            TextVertex top_right{{right, top}, {glyph.uv_max.x, glyph.uv_min.y}, color};
+            *out++ = top_left, *out++ = bottom_left, *out++ = bottom_right;
+            *out++ = top_left, *out++ = bottom_right, *out++ = top_right;
+
+            x += (float) glyph.advance * scale;
+        }
+        return out - begin;
+    }
 
-    explicit Font(const std::string &path) {
+public:
+    explicit Font(const std::string &path, int pixels = 48) {
         FT_Library ft;
         if (FT_Init_FreeType(&ft)) {
             std::cerr << "Could not init FreeType Library" << std::endl;
@@ -51,102 +124,165 @@ public:
         if (FT_New_Face(ft, font_name.c_str(), 0, &face)) {
             std::cerr << "Failed to load font" << std::endl;
             exit(-1);
-        } else {
-            FT_Set_Pixel_Sizes(face, 0, 48);
+        }
+        FT_Set_Pixel_Sizes(face, 0, pixels);
+
+        // Render every glyph and place it on shelves of the atlas from left to right, top to bottom
+        std::array<std::vector<unsigned char>, GLYPHS> bitmaps;
+        std::array<glm::ivec2, GLYPHS> origins{};
+        int x = PADDING, y = PADDING, shelf = 0;
+        for (int c = 0; c < GLYPHS; c++) {
+            if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+                std::cerr << "Failed to load Glyph " << c << std::endl;
+                continue;
+            }
 
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            const FT_Bitmap &bitmap = face->glyph->bitmap;
+            int w = (int) bitmap.width, h = (int) bitmap.rows;
+            if (x + w + PADDING > ATLAS_WIDTH) x = PADDING, y += shelf + PADDING, shelf = 0;
 
-            for (unsigned char c = 0; c < 128; c++) {
-                if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-                    std::cerr << "Failed to load Glyph " << c << std::endl;
-                    continue;
-                }
+            bitmaps[c].resize((std::size_t) w * h);
+            for (int row = 0; row < h; row++) {
+                std::copy_n(bitmap.buffer + row * bitmap.pitch, w, bitmaps[c].begin() + row * w);
+            }
+            origins[c] = glm::ivec2(x, y);
 
-                unsigned int texture;
-                glGenTextures(1, &texture);
-                glBindTexture(GL_TEXTURE_2D, texture);
-                glTexImage2D(
-                        GL_TEXTURE_2D,
-                        0,
-                        GL_RED,
-                        (int) face->glyph->bitmap.width,
-                        (int) face->glyph->bitmap.rows,
-                        0,
-                        GL_RED,
-                        GL_UNSIGNED_BYTE,
-                        face->glyph->bitmap.buffer
-                );
-
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-                Character character = {
-                        texture,
-                        glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                        glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                        static_cast<unsigned int>(face->glyph->advance.x)
-                };
-
-                characters.insert(std::pair<char, Character>(c, character));
+            glyphs[c].size = glm::ivec2(w, h);
+            glyphs[c].bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+            glyphs[c].advance = (int) (face->glyph->advance.x >> 6);
+
+            x += w + PADDING;
+            shelf = std::max(shelf, h);
+        }
+
+        if (FT_HAS_KERNING(face)) {
+            kerning.assign(GLYPHS * GLYPHS, 0);
+            for (int left = 0; left < GLYPHS; left++) {
+                FT_UInt left_index = FT_Get_Char_Index(face, left);
+                for (int right = 0; right < GLYPHS; right++) {
+                    FT_Vector delta{};
+                    if (FT_Get_Kerning(face, left_index, FT_Get_Char_Index(face, right), FT_KERNING_DEFAULT, &delta)) {
+                        continue;
+                    }
+                    kerning[left * GLYPHS + right] = (int) (delta.x >> 6);
+                }
             }
-            glBindTexture(GL_TEXTURE_2D, 0);
         }
 
         FT_Done_Face(face);
         FT_Done_FreeType(ft);
 
-        glGenVertexArrays(1, &vao);
-        glGenBuffers(1, &vbo);
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-    }
+        int atlas_height = 1;
+        while (atlas_height < y + shelf + PADDING) atlas_height <<= 1;
 
-    void render(Shader &shader, const std::string &text, float x, float y, float scale, glm::vec3 color) {
-        shader.enable();
-        shader.setUniform3f("textColor", color);
-        glUniform3f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z);
-        glActiveTexture(GL_TEXTURE0);
-        glBindVertexArray(vao);
+        std::vector<unsigned char> image((std::size_t) ATLAS_WIDTH * atlas_height, 0);
+        for (int c = 0; c < GLYPHS; c++) {
+            Glyph &glyph = glyphs[c];
+            for (int row = 0; row < glyph.size.y; row++) {
+                std::copy_n(bitmaps[c].begin() + row * glyph.size.x, glyph.size.x,
+                            image.begin() + (origins[c].y + row) * ATLAS_WIDTH + origins[c].x);
+            }
+            glyph.uv_min = glm::vec2(origins[c]) / glm::vec2(ATLAS_WIDTH, atlas_height);
+            glyph.uv_max = glm::vec2(origins[c] + glyph.size) / glm::vec2(ATLAS_WIDTH, atlas_height);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, atlas_height, 0, GL_RED, GL_UNSIGNED_BYTE,
+                     image.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
 
-        for (std::string::const_iterator c = text.begin(); c != text.end(); c++) {
-            Character ch = characters[*c];
+        createBuffer(vao, vbo);
+        createBuffer(retained_vao, retained_vbo);
+    }
 
-            float xpos = x + ch.bearing.x * scale;
-            float ypos = y - (ch.size.y - ch.bearing.y) * scale;
+    /**
+     * Lay out a string with its baseline starting at (x, y) in pixels, it is drawn with the next draw()
+     */
+    void add(std::string_view text, float x, float y, float scale, glm::vec3 color) {
+        std::size_t size = vertices.size();
+        vertices.resize(size + 6 * text.size());
+        vertices.resize(size + layout(text, text.size(), x, y, scale, color, vertices.data() + size));
+    }
 
-            float w = ch.size.x * scale;
-            float h = ch.size.y * scale;
+    /**
+     * Add a retained range of glyphs, unused glyphs stay degenerate and are never rasterized
+     * @return First glyph of the range
+     */
+    std::size_t retain(std::size_t glyphs_count) {
+        std::size_t first = retained.size() / 6;
+        retained.resize(retained.size() + 6 * glyphs_count, TextVertex{});
+        resized = true;
+        return first;
+    }
 
-            float vertices[6][4] = {
-                    {xpos,     ypos + h, 0.0f, 0.0f},
-                    {xpos,     ypos,     0.0f, 1.0f},
-                    {xpos + w, ypos,     1.0f, 1.0f},
+    /**
+     * Lay out a string into a retained range, replacing its previous contents
+     */
+    void update(std::size_t first, std::size_t glyphs_count, std::string_view text, float x, float y, float scale,
+                glm::vec3 color) {
+        TextVertex *begin = retained.data() + 6 * first;
+        std::size_t written = layout(text, glyphs_count, x, y, scale, color, begin);
+        std::fill(begin + written, begin + 6 * glyphs_count, TextVertex{});
+        if (resized) return;
+
+        glBindBuffer(GL_ARRAY_BUFFER, retained_vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) (6 * first * sizeof(TextVertex)),
+                        (GLsizeiptr) (6 * glyphs_count * sizeof(TextVertex)), begin);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
-                    {xpos,     ypos + h, 0.0f, 0.0f},
-                    {xpos + w, ypos,     1.0f, 1.0f},
-                    {xpos + w, ypos + h, 1.0f, 0.0f}
-            };
+    /**
+     * Draw every string added since the last call at once
+     */
+    void draw(Shader &shader) {
+        if (vertices.empty() && retained.empty()) return;
 
-            glBindTexture(GL_TEXTURE_2D, ch.ID);
+        if (!vertices.empty()) {
             glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+            // Orphan the old storage so that the driver never waits for the previous frame
+            capacity = std::max(capacity, vertices.size());
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (capacity * sizeof(TextVertex)), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) (vertices.size() * sizeof(TextVertex)), vertices.data());
             glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-
-            x += (ch.advance >> 6) * scale;
+        }
+        if (resized) {
+            glBindBuffer(GL_ARRAY_BUFFER, retained_vbo);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (retained.size() * sizeof(TextVertex)), retained.data(),
+                         GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            resized = false;
         }
 
+        shader.enable();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        if (!retained.empty()) {
+            glBindVertexArray(retained_vao);
+            glDrawArrays(GL_TRIANGLES, 0, (GLsizei) retained.size());
+        }
+        if (!vertices.empty()) {
+            glBindVertexArray(vao);
+            glDrawArrays(GL_TRIANGLES, 0, (GLsizei) vertices.size());
+        }
         glBindVertexArray(0);
         glBindTexture(GL_TEXTURE_2D, 0);
+
+        vertices.clear();
     }
 
+    void clear() const {
+        glDeleteTextures(1, &atlas);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &retained_vao);
+        glDeleteBuffers(1, &retained_vbo);
+    }
 };
 
 #endif // FONT_H
@@ -0,0 +1,71 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef TEXT_H
+#define TEXT_H
+
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <glm/glm.hpp>
+
+#include "font.h"
+
+// String laid out once into a retained range of a Font, drawn with every Font::draw until it changes. Setting the
+// same contents again costs a comparison, without allocation or layout.
+class Text {
+private:
+    Font *font = nullptr;
+    std::size_t first = 0, length = 0; // Range of glyphs in the font
+
+    std::string content;
+    glm::vec2 position = glm::vec2(0);
+    float scale = 1;
+    glm::vec3 color = glm::vec3(1);
+
+    void layout() {
+        font->update(first, length, content, position.x, position.y, scale, color);
+    }
+
+public:
+    Text() = default;
+
+    /**
+     * @param length Longest string the text can hold, longer ones are cut
+     */
+    Text(Font &font, std::size_t length, glm::vec2 position, float scale, glm::vec3 color) :
+            font(&font), first(font.retain(length)), length(length), position(position), scale(scale), color(color) {
+        content.reserve(length);
+    }
+
+    Text(Font &font, std::string_view text, glm::vec2 position, float scale, glm::vec3 color) :
+            Text(font, text.size(), position, scale, color) {
+        set(text);
+    }
+
+    void set(std::string_view text) {
+        text = text.substr(0, length);
+        if (text == content) return;
+        content.assign(text);
+        layout();
+    }
+
+    void set(int64_t value) {
+        char buffer[20];
+        auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        set(std::string_view(buffer, end - buffer));
+    }
+
+    void set(glm::vec3 tint) {
+        if (tint == color) return;
+        color = tint;
+        layout();
+    }
+};
+
+#endif // TEXT_H
@@ -0,0 +1,75 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+// Per-instance attributes of an instanced mesh, the vertex shader builds the transform from position and scale
+struct Instance {
+    static constexpr uint32_t VISIBLE = 1;
+
+    glm::vec3 position = glm::vec3(0);
+    glm::vec3 scale = glm::vec3(1);
+    glm::vec4 color = glm::vec4(1);
+    uint32_t flags = VISIBLE;
+};
+
+// Vertex buffer of Instance records, streamed once per frame and attached to whichever mesh draws them
+class InstanceBuffer {
+private:
+    unsigned int vbo = 0;
+    std::size_t capacity = 0;
+
+public:
+    /**
+     * Replace the contents with count instances. The old storage is orphaned so that the driver never waits for the
+     * previous frame to finish reading it.
+     */
+    void upload(const Instance *instances, std::size_t count) {
+        if (vbo == 0) glGenBuffers(1, &vbo);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        capacity = std::max(capacity, count);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (capacity * sizeof(Instance)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) (count * sizeof(Instance)), instances);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void upload(const std::vector<Instance> &instances) {
+        upload(instances.data(), instances.size());
+    }
+
+    /**
+     * Point the bound VAO at this buffer, position, scale, color and flags go to locations first to first + 3
+     */
+    void attach(unsigned int first) const {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexAttribPointer(first, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *) offsetof(Instance, position));
+        glVertexAttribPointer(first + 1, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *) offsetof(Instance, scale));
+        glVertexAttribPointer(first + 2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *) offsetof(Instance, color));
+        glVertexAttribIPointer(first + 3, 1, GL_UNSIGNED_INT, sizeof(Instance), (void *) offsetof(Instance, flags));
+        for (unsigned int i = first; i < first + 4; i++) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void clear() const {
+        if (vbo > 0) glDeleteBuffers(1, &vbo);
+    }
+};
+
+#endif // INSTANCE_H
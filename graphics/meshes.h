@@ -0,0 +1,96 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef MESHES_H
+#define MESHES_H
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "vertex.h"
+
+// Reference to a mesh of a Meshes registry
+struct Mesh {
+    uint16_t index = 0;
+};
+
+// Every distinct geometry uploaded once under a name, objects only keep a Mesh to draw it.
+// Has to be created, used and cleared on the thread that owns the GL context.
+class Meshes {
+private:
+    std::vector<Vertex> meshes;
+    std::map<std::string, uint16_t> names;
+
+public:
+    /**
+     * Upload a mesh, or return the one already registered under the name
+     */
+    Mesh add(const std::string &name, const std::vector<float> &vertices, const std::vector<int> &layout,
+             const std::vector<uint16_t> &indices, GLenum mode = GL_TRIANGLES) {
+        auto found = names.find(name);
+        if (found != names.end()) return {found->second};
+
+        meshes.emplace_back(vertices, layout, indices, mode);
+        names[name] = (uint16_t) (meshes.size() - 1);
+        return {(uint16_t) (meshes.size() - 1)};
+    }
+
+    Mesh find(const std::string &name) const {
+        auto found = names.find(name);
+        if (found == names.end()) throw std::runtime_error("No mesh named " + name);
+        return {found->second};
+    }
+
+    Vertex &operator[](Mesh mesh) {
+        return meshes[mesh.index];
+    }
+
+    /**
+     * @return Unit cube centered on the origin
+     */
+    Mesh cube() {
+        return add("cube", {
+                -0.5f, -0.5f, -0.5f,
+                0.5f, -0.5f, -0.5f,
+                0.5f, 0.5f, -0.5f,
+                -0.5f, 0.5f, -0.5f,
+                -0.5f, -0.5f, 0.5f,
+                0.5f, -0.5f, 0.5f,
+                0.5f, 0.5f, 0.5f,
+                -0.5f, 0.5f, 0.5f
+        }, {3}, {
+                0, 2, 1, 0, 3, 2, // Negative Z
+                4, 5, 6, 4, 6, 7, // Positive Z
+                0, 4, 7, 0, 7, 3, // Negative X
+                1, 2, 6, 1, 6, 5, // Positive X
+                0, 1, 5, 0, 5, 4, // Negative Y
+                3, 7, 6, 3, 6, 2  // Positive Y
+        });
+    }
+
+    /**
+     * @return Line from the origin to (1, 1, 1), so that a scale of end - start places it between two points
+     */
+    Mesh segment() {
+        return add("segment", {
+                0.0f, 0.0f, 0.0f,
+                1.0f, 1.0f, 1.0f
+        }, {3}, {}, GL_LINES);
+    }
+
+    void clear() {
+        for (auto &mesh: meshes) mesh.clear();
+        meshes.clear();
+        names.clear();
+    }
+};
+
+#endif // MESHES_H
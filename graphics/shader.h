@@ -7,14 +7,36 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 #include <iostream>
-#include <map>
+
+// Every uniform the shaders of the game use outside of uniform blocks. A shader resolves all of them when it is
+// linked, so setting one is a lookup in a flat table.
+enum class Uniform : uint8_t {
+    TEXT, COUNT
+};
+
+// Uniform blocks shared by every shader, each one is bound to the binding point of its id
+enum class UniformBlock : uint8_t {
+    FRAME, COUNT
+};
 
 class Shader {
 public:
+    // GLSL names of the Uniform ids, in the same order
+    static constexpr const char *UNIFORM_NAMES[] = {"text"};
+    static_assert(std::size(UNIFORM_NAMES) == (std::size_t) Uniform::COUNT);
+
+    static constexpr const char *BLOCK_NAMES[] = {"Frame"};
+    static_assert(std::size(BLOCK_NAMES) == (std::size_t) UniformBlock::COUNT);
+
     unsigned int ID;
 
     Shader(const std::string &vertexPath, const std::string &fragmentPath) {
@@ -44,9 +66,9 @@ public:
             vShaderFile.close();
             fShaderFile.close();
 
-            // Convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            // Convert stream into string, pasting in included files
+            vertexCode = preprocess(vShaderStream.str());
+            fragmentCode = preprocess(fShaderStream.str());
         } catch (std::ifstream::failure &e) {
             std::cout << "Shader file not successfully read" << std::endl;
         }
@@ -76,6 +98,9 @@ public:
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
 
+        resolveUniforms();
+        bindBlocks();
+
         // Delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -91,40 +116,47 @@ public:
     }
 
     // Utility uniform functions
-    void setUniform1i(const std::string &name, int value) {
-        glUniform1i(getUniform(name), value);
+    void setUniform1i(Uniform uniform, int value) {
+        glUniform1i(location(uniform), value);
     }
 
-    void setUniform1f(const std::string &name, float value) {
-        glUniform1f(getUniform(name), value);
+    void setUniform1f(Uniform uniform, float value) {
+        glUniform1f(location(uniform), value);
     }
 
-    void setUniform2f(const std::string &name, float x, float y) {
-        glUniform2f(getUniform(name), x, y);
+    void setUniform2f(Uniform uniform, float x, float y) {
+        glUniform2f(location(uniform), x, y);
     }
 
-    void setUniform2f(const std::string &name, std::pair<float, float> value) {
-        glUniform2f(getUniform(name), value.first, value.second);
+    void setUniform2f(Uniform uniform, std::pair<float, float> value) {
+        glUniform2f(location(uniform), value.first, value.second);
     }
 
-    void setUniform3f(const std::string &name, float x, float y, float z) {
-        glUniform3f(getUniform(name), x, y, z);
+    void setUniform3f(Uniform uniform, float x, float y, float z) {
+        glUniform3f(location(uniform), x, y, z);
     }
 
-    void setUniform3f(const std::string &name, glm::vec3 &data) {
-        glUniform3f(getUniform(name), data.x, data.y, data.z);
+    void setUniform3f(Uniform uniform, const glm::vec3 &data) {
+        glUniform3f(location(uniform), data.x, data.y, data.z);
     }
 
-    void setUniform4f(const std::string &name, float x, float y, float z, float w) {
-        glUniform4f(getUniform(name), x, y, z, w);
+    void setUniform4f(Uniform uniform, float x, float y, float z, float w) {
+        glUniform4f(location(uniform), x, y, z, w);
     }
 
-    void setUniform4f(const std::string &name, glm::vec4 &data) {
-        glUniform4f(getUniform(name), data.x, data.y, data.z, data.w);
+    void setUniform4f(Uniform uniform, const glm::vec4 &data) {
+        glUniform4f(location(uniform), data.x, data.y, data.z, data.w);
     }
 
-    void setUniformMat4f(const std::string &name, const glm::mat4 &matrix) {
-        glUniformMatrix4fv(getUniform(name), 1, GL_FALSE, &matrix[0][0]);
+    void setUniformMat4f(Uniform uniform, const glm::mat4 &matrix) {
+        glUniformMatrix4fv(location(uniform), 1, GL_FALSE, &matrix[0][0]);
+    }
+
+    /**
+     * @return Location of the uniform in this program, -1 if the program doesn't use it, which GL ignores
+     */
+    [[nodiscard]] int location(Uniform uniform) const {
+        return locations[(std::size_t) uniform];
     }
 
 private:
@@ -150,22 +182,67 @@ private:
         }
     }
 
-    std::map<std::string, int> cache;
+    std::array<int, (std::size_t) Uniform::COUNT> locations{};
 
-    int getUniform(const std::string &name) {
-        if (cache.find(name) != cache.end())
-            return cache[name];
+    // Replace every line '#include "name"' with the contents of assets/shaders/name, GLSL has no includes of its own
+    static std::string preprocess(const std::string &code, int depth = 0) {
+        if (depth > 8) throw std::runtime_error("Shader includes nested too deep");
 
-        int result = glGetUniformLocation(ID, name.c_str());
+        std::stringstream input(code);
+        std::string result, line;
+        while (std::getline(input, line)) {
+            std::size_t begin = line.find('"'), end = line.rfind('"');
+            if (line.rfind("#include", 0) != 0 || begin == end) {
+                result += line + "\n";
+                continue;
+            }
 
-        if (result == -1) {
-            std::cerr << "Could not find uniform variable \'" + name + "\'!" << std::endl;
-        } else {
-            cache.insert({name, result});
+            std::string name = line.substr(begin + 1, end - begin - 1);
+            std::ifstream file("assets/shaders/" + name);
+            if (!file) throw std::runtime_error("Can't open the shader include " + name);
+            std::stringstream content;
+            content << file.rdbuf();
+            result += preprocess(content.str(), depth + 1);
         }
-
         return result;
     }
+
+    // Point the uniform blocks the program uses at their fixed binding points
+    void bindBlocks() const {
+        for (unsigned int i = 0; i < (unsigned int) UniformBlock::COUNT; i++) {
+            unsigned int index = glGetUniformBlockIndex(ID, BLOCK_NAMES[i]);
+            if (index != GL_INVALID_INDEX) glUniformBlockBinding(ID, index, i);
+        }
+    }
+
+    // Look up every active uniform of the linked program once
+    void resolveUniforms() {
+        locations.fill(-1);
+
+        int count = 0, length = 0, size = 0;
+        unsigned int type = 0;
+        char name[256];
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+
+        for (int i = 0; i < count; i++) {
+            // Members of uniform blocks are set through their buffer
+            int block = -1;
+            auto index = (unsigned int) i;
+            glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+            if (block != -1) continue;
+
+            glGetActiveUniform(ID, index, sizeof(name), &length, &size, &type, name);
+            std::string_view view(name, length);
+            if (view.ends_with("[0]")) view.remove_suffix(3);
+
+            auto found = std::find(std::begin(UNIFORM_NAMES), std::end(UNIFORM_NAMES), view);
+            if (found == std::end(UNIFORM_NAMES)) {
+                std::cerr << "Uniform variable \'" << view << "\' has no Uniform id!" << std::endl;
+                continue;
+            }
+            locations[found - std::begin(UNIFORM_NAMES)] = glGetUniformLocation(ID, name);
+        }
+    }
 };
 
 #endif
\ No newline at end of file
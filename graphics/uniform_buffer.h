@@ -0,0 +1,56 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "shader.h"
+
+// Contents of the Frame block of assets/shaders/frame.glsl in std140 layout, written once per frame
+struct FrameUniforms {
+    glm::mat4 projection = glm::mat4(1);
+    glm::mat4 view = glm::mat4(1);
+    glm::mat4 orthographic = glm::mat4(1); // Screen space in pixels
+    glm::vec4 viewport = glm::vec4(0); // Width, height, 1 / width, 1 / height
+    float time = 0; // Song time in s
+    float padding[3] = {};
+};
+
+static_assert(sizeof(FrameUniforms) == 3 * 64 + 16 + 16, "FrameUniforms must match the std140 layout of Frame");
+
+// Uniform buffer object holding a T, bound to the binding point of a block for every shader at once
+template<typename T>
+class UniformBuffer {
+private:
+    unsigned int ubo = 0;
+
+public:
+    UniformBuffer() = default;
+
+    explicit UniformBuffer(UniformBlock block) {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, (unsigned int) block, ubo);
+    }
+
+    void update(const T &data) {
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void clear() const {
+        glDeleteBuffers(1, &ubo);
+    }
+};
+
+#endif // UNIFORM_BUFFER_H
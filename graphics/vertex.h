@@ -8,64 +8,90 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <cstdint>
 #include <vector>
 
+#include "instance.h"
+
 class Vertex {
 private:
-    uint32_t vao = 0, vbo = 0, ebo = 0, tbo = 0;
-    int count;
+    uint32_t vao = 0, vbo = 0, ebo = 0;
+    int count = 0, attributes = 0;
+    GLenum mode = GL_TRIANGLES;
 
 public:
     Vertex() = default;
 
-    Vertex(const std::vector<float> &vertices, const std::vector<unsigned int> &indices,
-           const std::vector<float> &textures) {
-        count = (int) indices.size();
+    /**
+     * @param vertices Attributes of every vertex, interleaved
+     * @param layout Float components of each attribute, bound to locations 0, 1, ... in order
+     * @param indices Vertices of each primitive, empty to draw the vertices in order
+     */
+    Vertex(const std::vector<float> &vertices, const std::vector<int> &layout, const std::vector<uint16_t> &indices,
+           GLenum mode = GL_TRIANGLES) : attributes((int) layout.size()), mode(mode) {
+        int stride = 0;
+        for (int components: layout) stride += components;
+        count = indices.empty() ? (int) vertices.size() / stride : (int) indices.size();
 
         glGenVertexArrays(1, &vao);
         glBindVertexArray(vao);
 
         glGenBuffers(1, &vbo);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) nullptr);
-        glEnableVertexAttribArray(0);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (vertices.size() * sizeof(float)), vertices.data(), GL_STATIC_DRAW);
 
-        glGenBuffers(1, &tbo);
-        glBindBuffer(GL_ARRAY_BUFFER, tbo);
-        glBufferData(GL_ARRAY_BUFFER, textures.size() * sizeof(float), textures.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *) nullptr);
-        glEnableVertexAttribArray(1);
+        for (int i = 0, offset = 0; i < attributes; offset += layout[i++]) {
+            glVertexAttribPointer(i, layout[i], GL_FLOAT, GL_FALSE, stride * (int) sizeof(float),
+                                  (void *) (offset * sizeof(float)));
+            glEnableVertexAttribArray(i);
+        }
 
-        glGenBuffers(1, &ebo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        if (!indices.empty()) {
+            glGenBuffers(1, &ebo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) (indices.size() * sizeof(uint16_t)), indices.data(),
+                         GL_STATIC_DRAW);
+        }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     void bind() {
         glBindVertexArray(vao);
-        if (ebo > 0) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     }
 
     void unbind() {
-        if (ebo > 0) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
     }
 
     void draw() {
-        if (ebo > 0) glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
-        else glDrawArrays(GL_TRIANGLES, 0, count);
+        if (ebo > 0) glDrawElements(mode, count, GL_UNSIGNED_SHORT, nullptr);
+        else glDrawArrays(mode, 0, count);
+    }
+
+    /**
+     * Draw the mesh once per instance, the instance attributes follow the mesh attributes
+     */
+    void draw(InstanceBuffer &instances, std::size_t size) {
+        if (size == 0) return;
+        bind();
+        instances.attach(attributes);
+        if (ebo > 0) glDrawElementsInstanced(mode, count, GL_UNSIGNED_SHORT, nullptr, (GLsizei) size);
+        else glDrawArraysInstanced(mode, 0, count, (GLsizei) size);
+        unbind();
     }
 
     void render() {
         bind();
         draw();
     }
+
+    void clear() const {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        if (ebo > 0) glDeleteBuffers(1, &ebo);
+    }
 };
 
 #endif // VERTEX_H
-
@@ -4,21 +4,15 @@
 
 #include <GLFW/glfw3.h>
 
-struct Input {
-    int keys[GLFW_KEY_LAST], buttons[GLFW_MOUSE_BUTTON_LAST];
+#include "input.h"
 
-    bool is_key_down(int key) {
-        return keys[key] != GLFW_RELEASE;
-    }
-
-    bool is_mouse_down(int button) {
-        return buttons[button] != GLFW_RELEASE;
-    }
-} input;
+Input input;
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods) {
-    if (key != GLFW_KEY_UNKNOWN)
-        input.keys[key] = action;
+    if (key == GLFW_KEY_UNKNOWN) return;
+
+    input.keys[key] = action;
+    input.events.push({key, action, glfwGetTime()});
 }
 
 void cursor_position_callback(GLFWwindow *window, double xpos, double ypos) {
@@ -27,4 +21,4 @@ void cursor_position_callback(GLFWwindow *window, double xpos, double ypos) {
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods) {
     input.buttons[button] = action;
-}
\ No newline at end of file
+}
@@ -4,9 +4,21 @@
 
 #pragma once
 
+#include <GLFW/glfw3.h>
+
+#include "../utils/spsc_queue.h"
+
+struct KeyEvent {
+    int key, action;
+    double time; // glfwGetTime() when the callback ran
+};
+
 extern struct Input {
     int keys[GLFW_KEY_LAST], buttons[GLFW_MOUSE_BUTTON_LAST];
 
+    // Every key action in order, filled by key_callback and drained by the game
+    SPSCQueue<KeyEvent, 256> events;
+
     bool is_key_down(int key) {
         return keys[key] != GLFW_RELEASE;
     }
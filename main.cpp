@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -13,15 +16,22 @@
 #include "input/input.h"
 #include "utils/random.h"
 #include "utils/fft.h"
+#include "utils/triple_buffer.h"
+#include "audio/clock.h"
 #include "audio/sound.h"
 #include "game/game.h"
+#include "game/renderer.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 const int32_t width = 1920, height = 1080;
 
-const uint32_t framerate = 120;
+// Game logic runs at a fixed rate on the main thread, rendering as fast as the driver allows on its own thread
+const uint32_t tickrate = 1000;
+
+// Ticks simulated per wake up at most, a longer stall drops the backlog instead of catching up
+const uint32_t max_ticks = 100;
 
 extern void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
 
@@ -52,16 +62,8 @@ int main() {
     const GLFWvidmode *vidmode = glfwGetVideoMode(glfwGetPrimaryMonitor());
     glfwSetWindowPos(window, (vidmode->width - width) / 2, (vidmode->height - height) / 2);
 
-    glfwMakeContextCurrent(window);
     glfwShowWindow(window);
 
-    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
-
-    std::clog << "OpenGL: " << glGetString(GL_VERSION) << "\n";
-
     glfwSetKeyCallback(window, key_callback);
     glfwSetCursorPosCallback(window, cursor_position_callback);
     glfwSetErrorCallback([](int error, const char *description) -> void {
@@ -91,59 +93,106 @@ int main() {
     ALfloat listenerOri[] = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f};
     alListenerfv(AL_ORIENTATION, listenerOri);
 
-    // Wire - Frame mode
-    // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    std::string path = "assets/resources/yesterday.wav";
 
-    glEnable(GL_DEPTH_TEST);
-    // glEnable(GL_CULL_FACE);
-    // glCullFace(GL_BACK);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    Sound sound(path, false, true);
+    Clock clock(sound);
 
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    Game level(path, clock);
 
-    std::string path = "assets/resources/yesterday.wav";
+    const double tick = 1.0 / tickrate;
+    double simulated = 0; // Song time of the last tick
 
-    Game level(path);
+    TripleBuffer<Snapshot> snapshots;
+    std::atomic<bool> running = true;
 
-    Sound sound(path, false);
+    // The render thread owns the GL context, so a swap that blocks on vsync or the driver never delays input or logic
+    std::thread render([&] {
+        glfwMakeContextCurrent(window);
 
-    int fps = 0;
+        if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+            std::cerr << "Failed to initialize GLAD" << std::endl;
+            running = false;
+            return;
+        }
 
-    double currentTime, lastTime = glfwGetTime(), frameTime = glfwGetTime();
+        std::clog << "OpenGL: " << glGetString(GL_VERSION) << "\n";
 
-    sound.play();
+        // Wire - Frame mode
+        // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-    while (!glfwWindowShouldClose(window)) {
-        if (input.is_key_down(GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(window, true);
+        glEnable(GL_DEPTH_TEST);
+        // glEnable(GL_CULL_FACE);
+        // glCullFace(GL_BACK);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        fps += 1;
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        try {
+            Renderer renderer;
 
-        currentTime = glfwGetTime();
+            int fps = 0;
+            double currentTime, frameTime = glfwGetTime();
 
-        if (currentTime - frameTime >= 1.0) {
-            std::cout << fps << " fps\n";
-            fps = 0, frameTime = currentTime;
-        }
+            while (running) {
+                fps += 1;
+
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                currentTime = glfwGetTime();
 
-        // Todo. update
-        level.update();
+                if (currentTime - frameTime >= 1.0) {
+                    std::cout << fps << " fps\n";
+                    fps = 0, frameTime = currentTime;
+                }
 
-        if (currentTime - lastTime >= 1.0 / framerate) {
-            lastTime = currentTime;
+                // Draw between the last tick and the next one
+                Snapshot &snapshot = snapshots.read();
+                renderer.render(snapshot, std::clamp(clock.song_time(), snapshot.time, snapshot.time + tick));
+
+                glfwSwapBuffers(window);
+            }
+
+            renderer.clear();
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            running = false;
         }
 
-        level.render();
+        glfwMakeContextCurrent(nullptr);
+    });
+
+    sound.play();
+
+    while (running && !glfwWindowShouldClose(window)) {
+        // Sleep until the next tick is due, an input event wakes the thread right away and gets timestamped in its
+        // callback no matter how long the render thread takes for a frame
+        glfwWaitEventsTimeout(std::max(simulated + tick - clock.song_time(), 0.0));
 
-        glfwSwapBuffers(window);
+        if (input.is_key_down(GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(window, true);
+
+        clock.update();
+        double now = clock.song_time();
+
+        uint32_t ticks = 0;
+        while (simulated + tick <= now && ticks < max_ticks) {
+            simulated += tick, ticks++;
+            level.update(simulated);
+        }
+        if (ticks == max_ticks) simulated = std::max(simulated, now - tick);
 
-        glfwPollEvents();
+        if (ticks > 0) {
+            level.snapshot(snapshots.write(), simulated);
+            snapshots.publish();
+        }
     }
 
+    running = false;
+    render.join();
+
     sound.stop();
-    level.clear();
+    clock.report(std::clog);
 
     glfwTerminate();
     device = alcGetContextsDevice(context);
@@ -0,0 +1,55 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef ALIGNED_H
+#define ALIGNED_H
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Allocator returning cache line aligned storage, so that SIMD kernels can use aligned loads
+template<typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T *p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const {
+        return true;
+    }
+};
+
+template<typename T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * @return n rounded up so that consecutive rows of n elements stay aligned
+ */
+template<typename T, std::size_t Alignment = 64>
+constexpr std::size_t aligned_size(std::size_t n) {
+    constexpr std::size_t step = Alignment / sizeof(T);
+    return (n + step - 1) / step * step;
+}
+
+#endif // ALIGNED_H
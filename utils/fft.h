@@ -8,38 +8,353 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <complex>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "thread_pool.h"
 #include "wav.h"
 
-// DFT & IDFT
-void fft(std::vector<std::complex<double>> &a, bool inv = false) {
-    int n = (int) a.size();
-    assert(n == (1 << __builtin_ctz(n)));
-
-    for (int i = 1, j = 0; i < n; i++) {
-        int bit = n >> 1;
-        while (!((j ^= bit) & bit)) bit >>= 1;
-        if (i < j) swap(a[i], a[j]);
-    }
-
-    for (int i = 1; i < n; i <<= 1) {
-        double x = inv ? M_PI / i : -M_PI / i;
-        std::complex<double> w(cos(x), sin(x));
-        for (int j = 0; j < n; j += i << 1) {
-            std::complex<double> p(1, 0);
-            for (int k = 0; k < i; k++) {
-                std::complex<double> tmp = a[i + j + k] * p;
-                a[i + j + k] = a[j + k] - tmp;
-                a[j + k] += tmp;
-                p *= w;
+// Precomputed permutation and twiddle factors for one transform size.
+// Sizes made of 2, 3, 4, 5 and 7 run as a mixed radix transform, anything else through Bluestein's chirp-z algorithm.
+class FFTPlan {
+private:
+    using complex = std::complex<double>;
+
+    int n;
+    std::vector<int> radices;
+    std::vector<std::pair<int, int>> swaps; // Digit reversal permutation as a sequence of swaps
+    std::vector<int> order;
+    std::vector<complex> twiddle; // exp(-2 pi i k / n) for k < n
+
+    // Bluestein, a circular convolution with a chirp through a power of two transform of at least 2n - 1 points
+    const FFTPlan *inner = nullptr;
+    std::vector<complex> chirp, kernel;
+
+    // Multiplication by -i, or by i for the inverse, is a swap of the parts
+    template<bool INV>
+    static complex rotate(complex z) {
+        return INV ? complex(-z.imag(), z.real()) : complex(z.imag(), -z.real());
+    }
+
+    template<int R, bool INV>
+    void butterfly(complex *out, int m, int stride) const {
+        // Roots of unity of the generic radix, exp(-2 pi i p / R) or their conjugates
+        static const auto roots = [] {
+            std::array<complex, R> result;
+            for (int p = 0; p < R; p++) result[p] = std::polar(1.0, (INV ? 2 : -2) * M_PI * p / R);
+            return result;
+        }();
+
+        int length = m * R;
+        for (int j = 0; j < n; j += length) {
+            for (int k = 0; k < m; k++) {
+                complex x[R];
+                x[0] = out[j + k];
+                for (int q = 1; q < R; q++) {
+                    complex w = twiddle[q * k * stride];
+                    x[q] = out[j + k + q * m] * (INV ? std::conj(w) : w);
+                }
+
+                if constexpr (R == 2) {
+                    out[j + k] = x[0] + x[1];
+                    out[j + k + m] = x[0] - x[1];
+                } else if constexpr (R == 3) {
+                    constexpr double s = 0.86602540378443864676; // sin(2 pi / 3)
+                    complex a = x[1] + x[2], b = rotate<INV>(s * (x[1] - x[2]));
+                    complex c = x[0] - 0.5 * a;
+                    out[j + k] = x[0] + a;
+                    out[j + k + m] = c + b;
+                    out[j + k + 2 * m] = c - b;
+                } else if constexpr (R == 4) {
+                    complex a = x[0] + x[2], b = x[0] - x[2], c = x[1] + x[3], d = rotate<INV>(x[1] - x[3]);
+                    out[j + k] = a + c;
+                    out[j + k + m] = b + d;
+                    out[j + k + 2 * m] = a - c;
+                    out[j + k + 3 * m] = b - d;
+                } else if constexpr (R == 5) {
+                    // cos and sin of 2 pi / 5 and 4 pi / 5
+                    constexpr double c1 = 0.30901699437494742410, c2 = -0.80901699437494742410;
+                    constexpr double s1 = 0.95105651629515357212, s2 = 0.58778525229247312917;
+                    complex a1 = x[1] + x[4], b1 = x[1] - x[4], a2 = x[2] + x[3], b2 = x[2] - x[3];
+                    complex r1 = x[0] + c1 * a1 + c2 * a2, r2 = x[0] + c2 * a1 + c1 * a2;
+                    complex i1 = rotate<INV>(s1 * b1 + s2 * b2), i2 = rotate<INV>(s2 * b1 - s1 * b2);
+                    out[j + k] = x[0] + a1 + a2;
+                    out[j + k + m] = r1 + i1;
+                    out[j + k + 2 * m] = r2 + i2;
+                    out[j + k + 3 * m] = r2 - i2;
+                    out[j + k + 4 * m] = r1 - i1;
+                } else {
+                    for (int p = 0; p < R; p++) {
+                        complex sum = x[0];
+                        for (int q = 1, index = p; q < R; q++, index = index + p < R ? index + p : index + p - R) {
+                            sum += x[q] * roots[index];
+                        }
+                        out[j + k + p * m] = sum;
+                    }
+                }
+            }
+        }
+    }
+
+    // Butterfly stages over input that is already in digit reversed order
+    template<bool INV>
+    void mixed(complex *out) const {
+        for (int m = 1, s = 0; s < (int) radices.size(); m *= radices[s++]) {
+            int stride = n / (m * radices[s]);
+            switch (radices[s]) {
+                case 2:
+                    butterfly<2, INV>(out, m, stride);
+                    break;
+                case 3:
+                    butterfly<3, INV>(out, m, stride);
+                    break;
+                case 4:
+                    butterfly<4, INV>(out, m, stride);
+                    break;
+                case 5:
+                    butterfly<5, INV>(out, m, stride);
+                    break;
+                default:
+                    butterfly<7, INV>(out, m, stride);
+                    break;
+            }
+        }
+    }
+
+    void bluestein(const complex *in, complex *out, bool inv) const {
+        static thread_local std::vector<complex> buffer;
+        int m = inner->size();
+        buffer.resize(m);
+
+        // The inverse is the conjugate of the forward transform of the conjugate
+        for (int k = 0; k < n; k++) buffer[k] = (inv ? std::conj(in[k]) : in[k]) * chirp[k];
+        std::fill(buffer.begin() + n, buffer.end(), complex());
+
+        inner->execute(buffer.data(), buffer.data());
+        for (int k = 0; k < m; k++) buffer[k] *= kernel[k];
+        inner->execute(buffer.data(), buffer.data(), true);
+
+        for (int k = 0; k < n; k++) out[k] = inv ? std::conj(buffer[k] * chirp[k]) : buffer[k] * chirp[k];
+    }
+
+public:
+    explicit FFTPlan(int n) : n(n) {
+        if (n <= 0) throw std::invalid_argument("Invalid FFT size " + std::to_string(n));
+
+        int rest = n;
+        while (rest % 4 == 0) radices.push_back(4), rest /= 4;
+        while (rest % 2 == 0) radices.push_back(2), rest /= 2;
+        for (int p: {3, 5, 7})
+            while (rest % p == 0) radices.push_back(p), rest /= p;
+
+        if (rest > 1) {
+            radices.clear();
+
+            int m = 1;
+            while (m < 2 * n - 1) m <<= 1;
+            inner = &get(m);
+
+            // k^2 is reduced modulo 2n first so the angle stays exact for large k
+            chirp.resize(n);
+            for (int64_t k = 0; k < n; k++) chirp[k] = std::polar(1.0, -M_PI * double(k * k % (2 * n)) / n);
+
+            kernel.assign(m, complex());
+            kernel[0] = std::conj(chirp[0]);
+            for (int k = 1; k < n; k++) kernel[k] = kernel[m - k] = std::conj(chirp[k]);
+            inner->execute(kernel.data(), kernel.data());
+            return;
+        }
+
+        // Each factor is evaluated directly, a running product would lose accuracy along the table
+        twiddle.resize(n);
+        for (int k = 0; k < n; k++) twiddle[k] = std::polar(1.0, -2 * M_PI * k / n);
+
+        // Input i lands where the reversed mixed radix digits of i point to
+        order.resize(n);
+        for (int i = 0; i < n; i++) {
+            int position = 0;
+            for (int s = (int) radices.size() - 1, rem = i, size = n; s >= 0; s--) {
+                size /= radices[s];
+                position += rem % radices[s] * size;
+                rem /= radices[s];
+            }
+            order[i] = position;
+        }
+
+        std::vector<bool> visited(n);
+        for (int i = 0; i < n; i++) {
+            if (visited[i]) continue;
+            visited[i] = true;
+            for (int j = order[i]; j != i; j = order[j]) {
+                swaps.emplace_back(i, j);
+                visited[j] = true;
             }
         }
     }
-    if (inv)
-        for (int i = 0; i < n; i++) a[i] /= n;
+
+    /**
+     * @return Shared plan for size n, built on first use
+     */
+    static const FFTPlan &get(int n) {
+        static std::recursive_mutex lock;
+        static std::map<int, std::unique_ptr<FFTPlan>> plans;
+
+        std::lock_guard<std::recursive_mutex> guard(lock);
+        auto &plan = plans[n];
+        if (!plan) plan = std::make_unique<FFTPlan>(n);
+        return *plan;
+    }
+
+    [[nodiscard]] int size() const {
+        return n;
+    }
+
+    /**
+     * Transform n values of in into out, which may be the same array.
+     */
+    void execute(const complex *in, complex *out, bool inv = false) const {
+        if (inner) {
+            bluestein(in, out, inv);
+        } else {
+            if (in == out) {
+                for (auto &[i, j]: swaps) std::swap(out[i], out[j]);
+            } else {
+                for (int i = 0; i < n; i++) out[order[i]] = in[i];
+            }
+            if (inv) mixed<true>(out);
+            else mixed<false>(out);
+        }
+        if (inv)
+            for (int i = 0; i < n; i++) out[i] /= n;
+    }
+
+    void execute(const std::vector<complex> &in, std::vector<complex> &out, bool inv = false) const {
+        assert((int) in.size() == n);
+        out.resize(n);
+        execute(in.data(), out.data(), inv);
+    }
+};
+
+// Transform of n real values through a complex transform of n / 2 points, keeping the n / 2 + 1 non-redundant bins.
+// Odd sizes can't be split in halves and go through a full size complex transform instead.
+class RealFFT {
+private:
+    int n;
+    const FFTPlan &half;
+    std::vector<std::complex<double>> twiddle; // exp(-2 pi i k / n) for k < n / 2
+
+    static int checked(int n) {
+        if (n <= 0) throw std::invalid_argument("Invalid FFT size " + std::to_string(n));
+        return n;
+    }
+
+    static std::vector<std::complex<double>> &scratch(int size) {
+        static thread_local std::vector<std::complex<double>> buffer;
+        buffer.resize(std::max<std::size_t>(buffer.size(), size));
+        return buffer;
+    }
+
+public:
+    explicit RealFFT(int n) : n(checked(n)), half(FFTPlan::get(n % 2 ? n : n / 2)), twiddle(n / 2) {
+        for (int k = 0; k < n / 2; k++) twiddle[k] = std::polar(1.0, -2 * M_PI * k / n);
+    }
+
+    static const RealFFT &get(int n) {
+        static std::mutex lock;
+        static std::map<int, std::unique_ptr<RealFFT>> plans;
+
+        std::lock_guard<std::mutex> guard(lock);
+        auto &plan = plans[n];
+        if (!plan) plan = std::make_unique<RealFFT>(n);
+        return *plan;
+    }
+
+    [[nodiscard]] int size() const {
+        return n;
+    }
+
+    [[nodiscard]] int bins() const {
+        return n / 2 + 1;
+    }
+
+    /**
+     * Spectrum of n real samples.
+     * @param out bins() values, the first n / 2 of them double as the buffer of the half size transform
+     */
+    template<typename T>
+    void forward(const T *in, std::complex<double> *out) const {
+        if (n % 2) {
+            auto &buffer = scratch(n);
+            for (int i = 0; i < n; i++) buffer[i] = {(double) in[i], 0};
+            half.execute(buffer.data(), buffer.data());
+            std::copy(buffer.begin(), buffer.begin() + bins(), out);
+            return;
+        }
+
+        int h = n / 2;
+        for (int m = 0; m < h; m++) out[m] = {(double) in[2 * m], (double) in[2 * m + 1]};
+        half.execute(out, out);
+
+        // Split the even and odd parts of each pair of mirrored bins and recombine them, in place
+        std::complex<double> z = out[0];
+        out[0] = {z.real() + z.imag(), 0};
+        out[h] = {z.real() - z.imag(), 0};
+
+        for (int k = 1; k <= h / 2; k++) {
+            std::complex<double> a = out[k], b = std::conj(out[h - k]);
+            std::complex<double> even = (a + b) * 0.5, odd = (a - b) * std::complex<double>(0, -0.5);
+            std::complex<double> w = twiddle[k] * odd;
+            out[k] = even + w;
+            out[h - k] = std::conj(even - w);
+        }
+    }
+
+    /**
+     * Real signal of a spectrum produced by forward().
+     * @param spectrum bins() values, overwritten during the transform
+     */
+    template<typename T>
+    void inverse(std::complex<double> *spectrum, T *out) const {
+        if (n % 2) {
+            auto &buffer = scratch(n);
+            std::copy(spectrum, spectrum + bins(), buffer.begin());
+            for (int k = bins(); k < n; k++) buffer[k] = std::conj(spectrum[n - k]);
+            half.execute(buffer.data(), buffer.data(), true);
+            for (int i = 0; i < n; i++) out[i] = (T) buffer[i].real();
+            return;
+        }
+
+        int h = n / 2;
+        std::complex<double> first = spectrum[0], last = spectrum[h];
+        spectrum[0] = {(first.real() + last.real()) * 0.5, (first.real() - last.real()) * 0.5};
+
+        for (int k = 1; k <= h / 2; k++) {
+            std::complex<double> a = spectrum[k], b = spectrum[h - k];
+            std::complex<double> even = (a + std::conj(b)) * 0.5, odd = (a - std::conj(b)) * 0.5 * std::conj(twiddle[k]);
+            std::complex<double> mirror_even = (b + std::conj(a)) * 0.5;
+            std::complex<double> mirror_odd = (b - std::conj(a)) * 0.5 * std::conj(twiddle[h - k]);
+            spectrum[k] = even + std::complex<double>(0, 1) * odd;
+            spectrum[h - k] = mirror_even + std::complex<double>(0, 1) * mirror_odd;
+        }
+        half.execute(spectrum, spectrum, true);
+
+        for (int m = 0; m < h; m++) {
+            out[2 * m] = (T) spectrum[m].real();
+            out[2 * m + 1] = (T) spectrum[m].imag();
+        }
+    }
+};
+
+// DFT & IDFT
+void fft(std::vector<std::complex<double>> &a, bool inv = false) {
+    FFTPlan::get((int) a.size()).execute(a.data(), a.data(), inv);
 }
 
 // Todo. Fix
@@ -50,7 +365,9 @@ std::vector<int> fft(Audio &audio) {
     int n = 1;
     while (n < audio.size()) n <<= 1;
     a.resize(n);
-    for (int i = 0; i < audio.size(); i++) a[i] = {(double) audio[i].first, 0};
+    std::vector<float> samples(audio.size());
+    audio.mono(0, audio.size(), nullptr, samples.data());
+    for (int i = 0; i < audio.size(); i++) a[i] = {(double) samples[i], 0};
     fft(a);
 
     std::ofstream out("test.txt");
@@ -64,21 +381,36 @@ std::vector<int> fft(Audio &audio) {
 }
 
 // Todo. Maybe better peak detection
-std::vector<std::vector<int>> fft(Audio &audio, int bucket, int min_dist = 10) {
-    std::vector<std::vector<int>> peaks;
-
-    // assert(bucket == (1 << __builtin_ctz(bucket)));
-
+// Buckets are analyzed in parallel on the pool, each worker with its own buffers, and the result keeps bucket order
+std::vector<std::vector<int>> fft(Audio &audio, int bucket, int min_dist = 10, ThreadPool &pool = ThreadPool::shared()) {
+    // Buckets are zero padded to a power of two, an odd bucket such as 11025 would lose the half size real transform
     int n = 1;
     while (n < bucket) n <<= 1;
+    const RealFFT &plan = RealFFT::get(n);
 
-    for (int i = 0; i < (audio.size() + bucket - 1) / bucket; i++) {
-        std::vector<std::complex<double>> a(n);
-        for (int j = i * bucket; j < std::min((i + 1) * bucket, (int) audio.size()); j++)
-            a[j - i * bucket] = {(double) audio[j].first, 0};
-        fft(a);
-
+    struct Scratch {
+        std::vector<float> samples;
+        std::vector<std::complex<double>> a;
         std::vector<std::pair<int, double>> frequencies;
+        std::vector<std::pair<double, int>> possible;
+    };
+    std::vector<Scratch> scratch(pool.size());
+    for (auto &buffers: scratch) {
+        buffers.samples.resize(n);
+        buffers.a.resize(plan.bins());
+    }
+
+    std::vector<std::vector<int>> peaks((audio.size() + bucket - 1) / bucket);
+
+    pool.parallel_for(peaks.size(), [&](std::size_t i, std::size_t worker) {
+        auto &[samples, a, frequencies, possible] = scratch[worker];
+
+        int count = std::min(int(i + 1) * bucket, (int) audio.size()) - int(i) * bucket;
+        audio.mono(i * bucket, count, nullptr, samples.data());
+        std::fill(samples.begin() + count, samples.end(), 0.0f);
+        plan.forward(samples.data(), a.data());
+
+        frequencies.clear();
 
         double avg = 0;
 
@@ -91,7 +423,7 @@ std::vector<std::vector<int>> fft(Audio &audio, int bucket, int min_dist = 10) {
             else frequencies.emplace_back(freq, magnitude);
         }
 
-        std::vector<std::pair<double, int>> possible;
+        possible.clear();
         for (int descent = 0, j = 1; j < frequencies.size(); j++) {
             if (frequencies[j].second > frequencies[j - 1].second) {
                 descent = 0;
@@ -107,14 +439,12 @@ std::vector<std::vector<int>> fft(Audio &audio, int bucket, int min_dist = 10) {
                       return a.first > b.first;
         });
 
-        std::vector<int> peak;
+        std::vector<int> &peak = peaks[i];
         for (auto &[x, y]: possible) {
             if (x > 1.7 + std::log10(avg) && (peak.empty() || std::abs(peak.back() - y) > min_dist))
                 peak.push_back(y);
         }
-
-        peaks.push_back(peak);
-    }
+    });
 
     return peaks;
 }
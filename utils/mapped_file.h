@@ -0,0 +1,142 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#define MAPPED_FILE_MMAP 1
+#elif __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#else
+#define MAPPED_FILE_MMAP 0
+#endif
+
+// Read-only view over a whole file. The file is memory mapped where the platform allows it,
+// otherwise it is read into memory with a single bulk read.
+class MappedFile {
+private:
+    const uint8_t *bytes = nullptr;
+    std::size_t length = 0;
+
+    std::vector<uint8_t> fallback;
+
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+#elif MAPPED_FILE_MMAP
+    int fd = -1;
+#endif
+
+    bool map(const std::string &path) {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) return false;
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) return false;
+
+        bytes = (const uint8_t *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (bytes == nullptr) return false;
+
+        length = (std::size_t) file_size.QuadPart;
+        return true;
+#elif MAPPED_FILE_MMAP
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) return false;
+
+        void *view = mmap(nullptr, (std::size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) return false;
+        madvise(view, (std::size_t) st.st_size, MADV_SEQUENTIAL);
+
+        bytes = (const uint8_t *) view;
+        length = (std::size_t) st.st_size;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void unmap() {
+#if defined(_WIN32)
+        if (bytes != nullptr && fallback.empty()) UnmapViewOfFile(bytes);
+        if (mapping != nullptr) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr, file = INVALID_HANDLE_VALUE;
+#elif MAPPED_FILE_MMAP
+        if (bytes != nullptr && fallback.empty()) munmap((void *) bytes, length);
+        if (fd >= 0) close(fd);
+        fd = -1;
+#endif
+        bytes = nullptr, length = 0;
+    }
+
+public:
+    explicit MappedFile(const std::string &path) {
+        if (map(path)) return;
+        unmap();
+
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            throw std::runtime_error("Can't open the file " + path);
+        }
+
+        fallback.resize((std::size_t) in.tellg());
+        in.seekg(0);
+        in.read((char *) fallback.data(), (std::streamsize) fallback.size());
+
+        bytes = fallback.data();
+        length = fallback.size();
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    [[nodiscard]] const uint8_t *data() const {
+        return bytes;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return length;
+    }
+
+    /**
+     * @return Whether the view is backed by a mapping rather than a heap copy
+     */
+    [[nodiscard]] bool mapped() const {
+        return fallback.empty() && bytes != nullptr;
+    }
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,124 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef ONSET_H
+#define ONSET_H
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "stft.h"
+#include "thread_pool.h"
+#include "wav.h"
+
+struct Onset {
+    double time; // s
+    float strength; // Spectral flux at the peak relative to the strongest one, in (0, 1]
+};
+
+struct Onsets {
+    std::vector<Onset> onsets;
+
+    // Half-wave rectified spectral flux per frame, normalized to a maximum of 1
+    std::vector<float> envelope;
+    double rate = 0; // Envelope frames per second
+    double offset = 0; // Time of envelope frame 0 in s
+
+    [[nodiscard]] double time(double frame) const {
+        return offset + frame / rate;
+    }
+};
+
+// Spectral flux onset detection with an adaptive median threshold.
+// https://www.eecs.qmul.ac.uk/~simond/pub/2006/dafx.pdf
+class OnsetDetector {
+private:
+    STFT stft;
+
+    float compression, delta;
+    double threshold_window, peak_window, min_gap; // s
+
+    Spectrogram spectrogram;
+    std::vector<float> previous, current, window;
+
+public:
+    /**
+     * @param compression Gamma of the log(1 + gamma |X|) magnitude compression
+     * @param delta Offset added to the median threshold, relative to the strongest flux
+     * @param threshold_window Span of the moving median in s
+     * @param peak_window Span an onset has to be the maximum of in s
+     * @param min_gap Minimum time between two onsets in s
+     */
+    explicit OnsetDetector(STFT stft = STFT(1024, 512, Window::HANN), float compression = 1.0f, float delta = 0.06f,
+                           double threshold_window = 0.2, double peak_window = 0.06, double min_gap = 0.05)
+            : stft(std::move(stft)), compression(compression), delta(delta),
+              threshold_window(threshold_window), peak_window(peak_window), min_gap(min_gap) {}
+
+    Onsets detect(const Audio &audio, ThreadPool &pool = ThreadPool::shared()) {
+        Onsets result;
+
+        stft.compute(audio, spectrogram, pool);
+        result.rate = spectrogram.rate();
+        result.offset = spectrogram.time(0);
+
+        std::size_t frames = spectrogram.frames, bins = spectrogram.bins;
+        auto &envelope = result.envelope;
+        envelope.assign(frames, 0.0f);
+
+        // Flux of frame t is the summed increase of compressed magnitude since frame t - 1
+        previous.assign(bins, 0.0f), current.resize(bins);
+        for (std::size_t t = 0; t < frames; t++) {
+            const float *row = spectrogram.row(t);
+            float flux = 0;
+            for (std::size_t k = 0; k < bins; k++) {
+                current[k] = std::log1p(compression * row[k]);
+                flux += std::max(current[k] - previous[k], 0.0f);
+            }
+            if (t > 0) envelope[t] = flux;
+            std::swap(previous, current);
+        }
+
+        float peak = *std::max_element(envelope.begin(), envelope.end());
+        if (peak <= 0) return result;
+        for (auto &x: envelope) x /= peak;
+
+        auto half = [&](double seconds) {
+            return std::max(1, (int) std::lround(seconds * result.rate / 2));
+        };
+        int median = half(threshold_window), local = half(peak_window);
+        double last = -min_gap;
+
+        for (int t = 1; t + 1 < (int) frames; t++) {
+            float x = envelope[t];
+            if (x <= envelope[t - 1] || x < envelope[t + 1]) continue;
+
+            int begin = std::max(0, t - local), end = std::min((int) frames, t + local + 1);
+            if (*std::max_element(envelope.begin() + begin, envelope.begin() + end) > x) continue;
+
+            begin = std::max(0, t - median), end = std::min((int) frames, t + median + 1);
+            window.assign(envelope.begin() + begin, envelope.begin() + end);
+            std::nth_element(window.begin(), window.begin() + (long) window.size() / 2, window.end());
+            if (x < window[window.size() / 2] + delta) continue;
+
+            // Fit a parabola through the peak and its neighbours for a sub-frame position
+            double a = envelope[t - 1], b = x, c = envelope[t + 1];
+            double curve = a - 2 * b + c;
+            double shift = curve < 0 ? std::clamp(0.5 * (a - c) / curve, -0.5, 0.5) : 0.0;
+
+            double time = result.time(t + shift);
+            if (time - last < min_gap) continue;
+
+            result.onsets.push_back({time, x});
+            last = time;
+        }
+
+        return result;
+    }
+};
+
+#endif // ONSET_H
@@ -0,0 +1,364 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef PCM_H
+#define PCM_H
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define PCM_X86 1
+#else
+#define PCM_X86 0
+#endif
+
+// Conversion between interleaved PCM as stored in wav files and normalized float samples.
+// The hot kernels have SSE2 and AVX2 versions picked at runtime, with a scalar fallback for everything else.
+class PCM {
+public:
+    enum class Encoding {
+        UINT8, INT16, INT24, INT32, FLOAT32
+    };
+
+    static constexpr uint16_t WAVE_FORMAT_PCM = 1;
+    static constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+    static constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    static Encoding encoding(uint16_t format, uint16_t bits) {
+        if (format == WAVE_FORMAT_PCM) {
+            switch (bits) {
+                case 8:
+                    return Encoding::UINT8;
+                case 16:
+                    return Encoding::INT16;
+                case 24:
+                    return Encoding::INT24;
+                case 32:
+                    return Encoding::INT32;
+                default:
+                    break;
+            }
+        }
+        if (format == WAVE_FORMAT_IEEE_FLOAT && bits == 32) return Encoding::FLOAT32;
+
+        throw std::runtime_error("Unsupported sample format " + std::to_string(format) + " with "
+                                 + std::to_string(bits) + " bits per sample");
+    }
+
+    static constexpr std::size_t bytes(Encoding encoding) {
+        switch (encoding) {
+            case Encoding::UINT8:
+                return 1;
+            case Encoding::INT16:
+                return 2;
+            case Encoding::INT24:
+                return 3;
+            default:
+                return 4;
+        }
+    }
+
+    static float decode(const uint8_t *p, Encoding encoding) {
+        switch (encoding) {
+            case Encoding::UINT8:
+                return float(int(p[0]) - 128) * (1.0f / 128);
+            case Encoding::INT16: {
+                int16_t x;
+                std::memcpy(&x, p, 2);
+                return float(x) * (1.0f / 32768);
+            }
+            case Encoding::INT24: {
+                auto x = int32_t(uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 24) >> 8;
+                return float(x) * (1.0f / 8388608);
+            }
+            case Encoding::INT32: {
+                int32_t x;
+                std::memcpy(&x, p, 4);
+                return float(x) * (1.0f / 2147483648.0f);
+            }
+            case Encoding::FLOAT32: {
+                float x;
+                std::memcpy(&x, p, 4);
+                return x;
+            }
+        }
+        return 0;
+    }
+
+    static void encode(float x, Encoding encoding, uint8_t *p) {
+        auto quantize = [&](double scale) {
+            return (int64_t) std::clamp(std::nearbyint(x * scale), -scale, scale - 1);
+        };
+
+        switch (encoding) {
+            case Encoding::UINT8:
+                p[0] = uint8_t(quantize(128) + 128);
+                break;
+            case Encoding::INT16: {
+                auto v = (int16_t) quantize(32768);
+                std::memcpy(p, &v, 2);
+                break;
+            }
+            case Encoding::INT24: {
+                auto v = (int32_t) quantize(8388608);
+                p[0] = uint8_t(v), p[1] = uint8_t(v >> 8), p[2] = uint8_t(v >> 16);
+                break;
+            }
+            case Encoding::INT32: {
+                auto v = (int32_t) quantize(2147483648.0);
+                std::memcpy(p, &v, 4);
+                break;
+            }
+            case Encoding::FLOAT32:
+                std::memcpy(p, &x, 4);
+                break;
+        }
+    }
+
+    // One implementation of every kernel for a given instruction set
+    struct Kernels {
+        const char *name;
+
+        void (*mono)(const uint8_t *, Encoding, int, std::size_t, const float *, float *);
+
+        void (*deinterleave)(const uint8_t *, Encoding, int, std::size_t, float *const *);
+    };
+
+    /**
+     * @return Every kernel set the running CPU supports, the fastest last
+     */
+    static std::vector<const Kernels *> available() {
+        static const Kernels scalar = {"scalar", scalar_mono, scalar_deinterleave};
+        std::vector<const Kernels *> result = {&scalar};
+#if PCM_X86
+        static const Kernels sse2 = {"sse2", sse2_mono, sse2_deinterleave};
+        static const Kernels avx2 = {"avx2", avx2_mono, avx2_deinterleave};
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2")) result.push_back(&sse2);
+        if (__builtin_cpu_supports("avx2")) result.push_back(&avx2);
+#endif
+        return result;
+    }
+
+    static const Kernels &kernels() {
+        static const Kernels *best = available().back();
+        return *best;
+    }
+
+    /**
+     * Convert interleaved frames to normalized float, average the channels down to one and multiply by a window,
+     * all in one pass.
+     * @param window Per frame weights, or nullptr for a rectangular window
+     */
+    static void mono(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, const float *window, float *dst) {
+        kernels().mono(src, encoding, channels, frames, window, dst);
+    }
+
+    /**
+     * Split interleaved frames into one normalized float array per channel.
+     */
+    static void deinterleave(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, float *const *dst) {
+        kernels().deinterleave(src, encoding, channels, frames, dst);
+    }
+
+    static void interleave(const float *const *src, Encoding encoding, int channels, std::size_t frames, uint8_t *dst) {
+        std::size_t size = bytes(encoding);
+        for (std::size_t i = 0; i < frames; i++) {
+            for (int c = 0; c < channels; c++, dst += size) encode(src[c][i], encoding, dst);
+        }
+    }
+
+    /**
+     * Print the throughput of every kernel set for each encoding and channel layout.
+     */
+    static void benchmark(std::ostream &out, std::size_t frames = 1 << 20, int repeat = 20) {
+        const Encoding encodings[] = {Encoding::INT16, Encoding::INT24, Encoding::INT32, Encoding::FLOAT32};
+        const char *names[] = {"int16", "int24", "int32", "float32"};
+
+        std::vector<float> window(frames, 0.5f), left(frames), right(frames);
+        float *planar[] = {left.data(), right.data()};
+
+        for (int e = 0; e < 4; e++) {
+            for (int channels = 1; channels <= 2; channels++) {
+                std::size_t size = bytes(encodings[e]);
+                std::vector<uint8_t> src(frames * channels * size);
+                for (std::size_t i = 0; i < frames * channels; i++) {
+                    encode(float(std::sin(double(i) * 0.001) * 0.9), encodings[e], src.data() + i * size);
+                }
+
+                for (auto *set: available()) {
+                    auto measure = [&](auto &&kernel) {
+                        auto begin = std::chrono::steady_clock::now();
+                        for (int r = 0; r < repeat; r++) kernel();
+                        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+                        return double(frames * channels) * repeat / elapsed.count() / 1e6;
+                    };
+
+                    double mixed = measure([&] {
+                        set->mono(src.data(), encodings[e], channels, frames, window.data(), left.data());
+                    });
+                    double split = measure([&] {
+                        set->deinterleave(src.data(), encodings[e], channels, frames, planar);
+                    });
+
+                    out << names[e] << " x" << channels << " " << set->name << ": mono " << mixed
+                        << " MSamples/s, deinterleave " << split << " MSamples/s\n";
+                }
+            }
+        }
+    }
+
+private:
+    static void scalar_mono(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, const float *window, float *dst) {
+        std::size_t size = bytes(encoding);
+        float scale = 1.0f / float(channels);
+        for (std::size_t i = 0; i < frames; i++) {
+            float sum = 0;
+            for (int c = 0; c < channels; c++, src += size) sum += decode(src, encoding);
+            dst[i] = sum * scale * (window ? window[i] : 1.0f);
+        }
+    }
+
+    static void scalar_deinterleave(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, float *const *dst) {
+        std::size_t size = bytes(encoding);
+        for (std::size_t i = 0; i < frames; i++) {
+            for (int c = 0; c < channels; c++, src += size) dst[c][i] = decode(src, encoding);
+        }
+    }
+
+#if PCM_X86
+    // Load 4 consecutive samples as normalized floats
+    __attribute__((target("sse2")))
+    static __m128 sse2_load(const uint8_t *p, Encoding encoding) {
+        if (encoding == Encoding::INT16) {
+            __m128i v = _mm_loadl_epi64((const __m128i *) p);
+            return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), _mm_set1_ps(1.0f / 32768));
+        }
+        if (encoding == Encoding::INT32) {
+            __m128i v = _mm_loadu_si128((const __m128i *) p);
+            return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / 2147483648.0f));
+        }
+        return _mm_loadu_ps((const float *) p);
+    }
+
+    __attribute__((target("sse2")))
+    static void sse2_mono(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, const float *window, float *dst) {
+        std::size_t i = 0, size = bytes(encoding);
+        if ((encoding == Encoding::INT16 || encoding == Encoding::INT32 || encoding == Encoding::FLOAT32) && channels <= 2) {
+            const __m128 half = _mm_set1_ps(0.5f);
+            for (; i + 4 <= frames; i += 4) {
+                const uint8_t *p = src + i * channels * size;
+                __m128 x = sse2_load(p, encoding);
+                if (channels == 2) {
+                    __m128 y = sse2_load(p + 4 * size, encoding);
+                    __m128 even = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+                    __m128 odd = _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1));
+                    x = _mm_mul_ps(_mm_add_ps(even, odd), half);
+                }
+                if (window) x = _mm_mul_ps(x, _mm_loadu_ps(window + i));
+                _mm_storeu_ps(dst + i, x);
+            }
+        }
+        scalar_mono(src + i * channels * size, encoding, channels, frames - i, window ? window + i : nullptr, dst + i);
+    }
+
+    __attribute__((target("sse2")))
+    static void sse2_deinterleave(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, float *const *dst) {
+        std::size_t i = 0, size = bytes(encoding);
+        if ((encoding == Encoding::INT16 || encoding == Encoding::INT32 || encoding == Encoding::FLOAT32) && channels <= 2) {
+            for (; i + 4 <= frames; i += 4) {
+                const uint8_t *p = src + i * channels * size;
+                __m128 x = sse2_load(p, encoding);
+                if (channels == 2) {
+                    __m128 y = sse2_load(p + 4 * size, encoding);
+                    _mm_storeu_ps(dst[0] + i, _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm_storeu_ps(dst[1] + i, _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1)));
+                } else _mm_storeu_ps(dst[0] + i, x);
+            }
+        }
+        float *rest[2] = {dst[0] + i, channels > 1 ? dst[1] + i : nullptr};
+        if (channels <= 2) scalar_deinterleave(src + i * channels * size, encoding, channels, frames - i, rest);
+        else scalar_deinterleave(src, encoding, channels, frames, dst);
+    }
+
+    // Load 8 consecutive samples as normalized floats, 24-bit samples read 4 bytes past the last one
+    __attribute__((target("avx2")))
+    static __m256 avx2_load(const uint8_t *p, Encoding encoding) {
+        if (encoding == Encoding::INT16) {
+            __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) p));
+            return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / 32768));
+        }
+        if (encoding == Encoding::INT24) {
+            // Move every 3 byte sample into the top of a 32-bit lane and shift the sign back down
+            const __m128i spread = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+            __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) p), spread);
+            __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p + 12)), spread);
+            __m256i v = _mm256_srai_epi32(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), 8);
+            return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / 8388608));
+        }
+        if (encoding == Encoding::INT32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *) p);
+            return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / 2147483648.0f));
+        }
+        return _mm256_loadu_ps((const float *) p);
+    }
+
+    // Number of frames the 8-wide loads may cover without reading past the end of the buffer
+    static std::size_t avx2_frames(Encoding encoding, int channels, std::size_t frames) {
+        if (encoding == Encoding::UINT8 || channels > 2) return 0;
+        if (encoding != Encoding::INT24) return frames;
+        std::size_t slack = (4 + 3 * channels - 1) / (3 * channels);
+        return frames > slack ? frames - slack : 0;
+    }
+
+    __attribute__((target("avx2")))
+    static void avx2_mono(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, const float *window, float *dst) {
+        std::size_t i = 0, size = bytes(encoding), limit = avx2_frames(encoding, channels, frames);
+        const __m256 half = _mm256_set1_ps(0.5f);
+        for (; i + 8 <= limit; i += 8) {
+            const uint8_t *p = src + i * channels * size;
+            __m256 x = avx2_load(p, encoding);
+            if (channels == 2) {
+                __m256 sum = _mm256_hadd_ps(x, avx2_load(p + 8 * size, encoding));
+                x = _mm256_mul_ps(_mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), 0xD8)), half);
+            }
+            if (window) x = _mm256_mul_ps(x, _mm256_loadu_ps(window + i));
+            _mm256_storeu_ps(dst + i, x);
+        }
+        scalar_mono(src + i * channels * size, encoding, channels, frames - i, window ? window + i : nullptr, dst + i);
+    }
+
+    __attribute__((target("avx2")))
+    static void avx2_deinterleave(const uint8_t *src, Encoding encoding, int channels, std::size_t frames, float *const *dst) {
+        std::size_t i = 0, size = bytes(encoding), limit = avx2_frames(encoding, channels, frames);
+        for (; i + 8 <= limit; i += 8) {
+            const uint8_t *p = src + i * channels * size;
+            __m256 x = avx2_load(p, encoding);
+            if (channels == 2) {
+                __m256 y = avx2_load(p + 8 * size, encoding);
+                __m256 even = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+                __m256 odd = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm256_storeu_ps(dst[0] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(even), 0xD8)));
+                _mm256_storeu_ps(dst[1] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(odd), 0xD8)));
+            } else _mm256_storeu_ps(dst[0] + i, x);
+        }
+        float *rest[2] = {dst[0] + i, channels > 1 ? dst[1] + i : nullptr};
+        if (channels <= 2) scalar_deinterleave(src + i * channels * size, encoding, channels, frames - i, rest);
+        else scalar_deinterleave(src, encoding, channels, frames, dst);
+    }
+#endif
+};
+
+#endif // PCM_H
@@ -0,0 +1,13 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#include <iostream>
+
+#include "pcm.h"
+
+// Throughput of every PCM kernel set on the running CPU
+int main() {
+    PCM::benchmark(std::cout);
+    return 0;
+}
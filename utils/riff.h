@@ -0,0 +1,126 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef RIFF_H
+#define RIFF_H
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// RIFF container walker. Chunks are visited through their size fields, so the sample payload is never scanned.
+// https://www.mmsp.ece.mcgill.ca/Documents/AudioFormats/WAVE/WAVE.html
+class Riff {
+public:
+    struct Chunk {
+        char id[4] = {};
+        uint64_t offset = 0; // Offset of the payload from the beginning of the file
+        uint32_t size = 0;
+
+        [[nodiscard]] bool found() const {
+            return offset != 0;
+        }
+
+        [[nodiscard]] bool is(const char *tag) const {
+            return std::memcmp(id, tag, 4) == 0;
+        }
+    };
+
+    struct Index {
+        uint64_t size = 0;
+
+        Chunk fmt, data, list, smpl, cue;
+
+        std::vector<Chunk> chunks; // Every chunk in file order
+    };
+
+    /**
+     * Index a RIFF/WAVE file held in memory.
+     */
+    static Index parse(const uint8_t *bytes, std::size_t size) {
+        return walk(size, [&](uint64_t offset, void *out, std::size_t n) {
+            if (offset + n > size) return false;
+            std::memcpy(out, bytes + offset, n);
+            return true;
+        });
+    }
+
+    /**
+     * Index a RIFF/WAVE stream, seeking from chunk header to chunk header. The stream position is left unspecified.
+     */
+    static Index parse(std::istream &in) {
+        in.seekg(0, std::ios::end);
+        auto size = (uint64_t) in.tellg();
+
+        return walk(size, [&](uint64_t offset, void *out, std::size_t n) {
+            in.clear();
+            in.seekg((std::streamoff) offset);
+            return (bool) in.read((char *) out, (std::streamsize) n);
+        });
+    }
+
+    /**
+     * Write one chunk with its header and the pad byte required for odd sizes.
+     */
+    static void write(std::ostream &out, const char *id, const void *payload, uint32_t size) {
+        out.write(id, 4);
+        out.write((const char *) &size, 4);
+        out.write((const char *) payload, size);
+        if (size & 1) out.put(0);
+    }
+
+    /**
+     * @return Bytes taken by a chunk including its header and padding
+     */
+    static uint64_t span(uint32_t size) {
+        return 8 + uint64_t(size) + (size & 1);
+    }
+
+private:
+    template<typename Read>
+    static Index walk(uint64_t size, Read &&read) {
+        Index index;
+
+        char riff[12];
+        if (!read(0, riff, 12) || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+            throw std::runtime_error("Not a RIFF/WAVE file");
+        }
+        index.size = size;
+
+        for (uint64_t offset = 12; offset + 8 <= size;) {
+            uint8_t head[8];
+            if (!read(offset, head, 8)) break;
+
+            Chunk chunk;
+            std::memcpy(chunk.id, head, 4);
+            std::memcpy(&chunk.size, head + 4, 4);
+            chunk.offset = offset + 8;
+
+            // Streamed files may leave the size unset, the chunk then runs until the end of the file
+            if (chunk.offset + chunk.size > size) chunk.size = uint32_t(size - chunk.offset);
+
+            if (chunk.is("fmt ")) index.fmt = chunk;
+            else if (chunk.is("data")) index.data = chunk;
+            else if (chunk.is("LIST")) index.list = chunk;
+            else if (chunk.is("smpl")) index.smpl = chunk;
+            else if (chunk.is("cue ")) index.cue = chunk;
+            index.chunks.push_back(chunk);
+
+            offset += span(chunk.size);
+        }
+
+        if (!index.fmt.found() || index.fmt.size < 16) throw std::runtime_error("Missing fmt chunk");
+        if (!index.data.found()) throw std::runtime_error("Missing data chunk");
+
+        return index;
+    }
+};
+
+#endif // RIFF_H
@@ -0,0 +1,97 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Fixed capacity FIFO queue on one contiguous allocation. The capacity is rounded up to a power of two so that
+// wrapping around is a mask, and nothing is allocated after construction unless grow() is called.
+template<typename T>
+class RingBuffer {
+private:
+    std::vector<T> buffer;
+    std::size_t mask = 0, head = 0, tail = 0; // tail - head is the size, both only ever grow
+
+public:
+    RingBuffer() = default;
+
+    explicit RingBuffer(std::size_t capacity) {
+        reserve(capacity);
+    }
+
+    /**
+     * Drop every element and make room for at least capacity of them
+     */
+    void reserve(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) size <<= 1;
+        buffer.assign(size, T());
+        mask = size - 1, head = tail = 0;
+    }
+
+    /**
+     * Double the capacity, keeping the elements in order
+     */
+    void grow() {
+        std::vector<T> larger(std::max<std::size_t>(2 * buffer.size(), 1));
+        for (std::size_t i = 0; i < size(); i++) larger[i] = buffer[(head + i) & mask];
+        tail = size(), head = 0;
+        buffer = std::move(larger);
+        mask = buffer.size() - 1;
+    }
+
+    [[nodiscard]] std::size_t capacity() const {
+        return buffer.size();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return tail - head;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return head == tail;
+    }
+
+    [[nodiscard]] bool full() const {
+        return size() == buffer.size();
+    }
+
+    void push_back(const T &value) {
+        if (full()) throw std::runtime_error("Ring buffer overflow");
+        buffer[tail++ & mask] = value;
+    }
+
+    void pop_front() {
+        head++;
+    }
+
+    [[nodiscard]] const T &front() const {
+        return buffer[head & mask];
+    }
+
+    T &front() {
+        return buffer[head & mask];
+    }
+
+    /**
+     * @return Element i positions after the front
+     */
+    const T &operator[](std::size_t i) const {
+        return buffer[(head + i) & mask];
+    }
+
+    void clear() {
+        head = tail = 0;
+    }
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,80 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Lock-free queue for exactly one producer thread and one consumer thread. Capacity has to be a power of two.
+template<typename T, std::size_t Capacity>
+class SPSCQueue {
+private:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    std::array<T, Capacity> buffer;
+
+    // Each index is written by one side only, keep them on separate cache lines
+    alignas(64) std::atomic<std::size_t> head = 0;
+    alignas(64) std::atomic<std::size_t> tail = 0;
+
+public:
+    /**
+     * Producer side.
+     * @return false if the queue is full and the value was dropped
+     */
+    bool push(const T &value) {
+        std::size_t back = tail.load(std::memory_order_relaxed);
+        if (back - head.load(std::memory_order_acquire) == Capacity) return false;
+
+        buffer[back & (Capacity - 1)] = value;
+        tail.store(back + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side.
+     * @return false if the queue is empty
+     */
+    bool pop(T &value) {
+        std::size_t front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire)) return false;
+
+        value = buffer[front & (Capacity - 1)];
+        head.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side, drop the oldest value.
+     * @return false if the queue is empty
+     */
+    bool pop() {
+        std::size_t front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire)) return false;
+
+        head.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side.
+     * @return Oldest value without removing it, nullptr if the queue is empty
+     */
+    [[nodiscard]] const T *front() const {
+        std::size_t front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire)) return nullptr;
+        return &buffer[front & (Capacity - 1)];
+    }
+
+    [[nodiscard]] bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,154 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef STFT_H
+#define STFT_H
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "aligned.h"
+#include "fft.h"
+#include "thread_pool.h"
+#include "wav.h"
+
+enum class Window {
+    RECTANGULAR, HANN, HAMMING, BLACKMAN_HARRIS
+};
+
+// Magnitude spectrogram stored row-major as frames x bins, each row padded to a cache line
+struct Spectrogram {
+    std::size_t frames = 0, bins = 0, stride = 0;
+
+    int length = 0, hop = 0;
+    uint32_t sample_rate = 0;
+
+    aligned_vector<float> data;
+
+    [[nodiscard]] std::span<const float> operator[](std::size_t frame) const {
+        return {data.data() + frame * stride, bins};
+    }
+
+    float *row(std::size_t frame) {
+        return data.data() + frame * stride;
+    }
+
+    /**
+     * @return Time of the center of a frame in seconds
+     */
+    [[nodiscard]] double time(double frame) const {
+        return (frame * hop + length / 2.0) / sample_rate;
+    }
+
+    /**
+     * @return Frames per second
+     */
+    [[nodiscard]] double rate() const {
+        return double(sample_rate) / hop;
+    }
+
+    [[nodiscard]] double frequency(std::size_t bin) const {
+        return double(bin) * sample_rate / length;
+    }
+};
+
+// Short-time Fourier transform of the downmixed audio with overlapping windowed frames
+class STFT {
+private:
+    int length, hop;
+    aligned_vector<float> window;
+    const RealFFT &plan;
+
+public:
+    explicit STFT(int length = 2048, int hop = 512, Window type = Window::HANN)
+            : length(checked(length, hop)), hop(hop), window(make_window(type, length)), plan(RealFFT::get(length)) {}
+
+    // Validates the sizes before the window and the plan are built from them
+    static int checked(int length, int hop) {
+        if (length <= 0 || hop <= 0) {
+            throw std::runtime_error("Invalid STFT length " + std::to_string(length) + " and hop " + std::to_string(hop));
+        }
+        return length;
+    }
+
+    /**
+     * @return Periodic window of the given length, as used for spectral analysis
+     */
+    static aligned_vector<float> make_window(Window type, int length) {
+        aligned_vector<float> result(length, 1.0f);
+        for (int i = 0; i < length; i++) {
+            double x = 2 * M_PI * i / length;
+            switch (type) {
+                case Window::HANN:
+                    result[i] = float(0.5 - 0.5 * std::cos(x));
+                    break;
+                case Window::HAMMING:
+                    result[i] = float(0.54 - 0.46 * std::cos(x));
+                    break;
+                case Window::BLACKMAN_HARRIS:
+                    result[i] = float(0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2 * x) - 0.01168 * std::cos(3 * x));
+                    break;
+                default:
+                    break;
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] int size() const {
+        return length;
+    }
+
+    [[nodiscard]] int step() const {
+        return hop;
+    }
+
+    /**
+     * Fill out with the magnitudes of every frame. The last frame is zero padded, and out keeps its storage when
+     * it is already large enough so that it can be reused across songs.
+     */
+    void compute(const Audio &audio, Spectrogram &out, ThreadPool &pool = ThreadPool::shared()) const {
+        std::size_t size = audio.size();
+
+        out.frames = size <= (std::size_t) length ? 1 : 1 + (size - length + hop - 1) / hop;
+        out.bins = plan.bins();
+        out.stride = aligned_size<float>(out.bins);
+        out.length = length, out.hop = hop;
+        out.sample_rate = audio.sample_rate();
+        out.data.resize(out.frames * out.stride);
+
+        struct Scratch {
+            aligned_vector<float> samples;
+            std::vector<std::complex<double>> spectrum;
+        };
+        std::vector<Scratch> scratch(pool.size());
+        for (auto &buffers: scratch) {
+            buffers.samples.resize(length);
+            buffers.spectrum.resize(plan.bins());
+        }
+
+        pool.parallel_for(out.frames, [&](std::size_t frame, std::size_t worker) {
+            auto &[samples, spectrum] = scratch[worker];
+
+            std::size_t begin = frame * hop;
+            std::size_t count = begin < size ? std::min<std::size_t>(length, size - begin) : 0;
+            audio.mono(begin, count, window.data(), samples.data());
+            std::fill(samples.begin() + (std::ptrdiff_t) count, samples.end(), 0.0f);
+
+            plan.forward(samples.data(), spectrum.data());
+
+            float *row = out.row(frame);
+            for (std::size_t k = 0; k < out.bins; k++) row[k] = (float) std::abs(spectrum[k]);
+        });
+    }
+};
+
+#endif // STFT_H
@@ -0,0 +1,159 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef TEMPO_H
+#define TEMPO_H
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "fft.h"
+#include "onset.h"
+
+// Beat grid of a song. Times between two tracked beats are divided evenly, outside of them the period is extrapolated.
+struct Beats {
+    double bpm = 0;
+    double period = 0; // s
+    double phase = 0; // Time of the first beat in s
+
+    std::vector<double> beats; // s, ascending
+
+    /**
+     * @return Nearest point of the grid with subdivision points per beat
+     */
+    [[nodiscard]] double quantize(double time, int subdivision = 2) const {
+        if (beats.empty()) return time;
+
+        double begin, length;
+        if (time < beats.front()) {
+            length = period;
+            begin = beats.front() - std::ceil((beats.front() - time) / period) * period;
+        } else if (time >= beats.back()) {
+            length = period;
+            begin = beats.back() + std::floor((time - beats.back()) / period) * period;
+        } else {
+            auto next = std::upper_bound(beats.begin(), beats.end(), time);
+            begin = *(next - 1), length = *next - begin;
+        }
+
+        double step = length / subdivision;
+        return begin + std::round((time - begin) / step) * step;
+    }
+};
+
+// Tempo from the autocorrelation of the onset envelope, beats from dynamic programming.
+// https://www.ee.columbia.edu/~dpwe/pubs/Ellis07-beattrack.pdf
+class TempoEstimator {
+private:
+    double center, spread, min_bpm, max_bpm, tightness;
+
+    std::vector<double> envelope, correlation, score;
+    std::vector<std::complex<double>> spectrum;
+    std::vector<int> previous;
+
+    // Autocorrelation of the envelope for every lag, as the inverse transform of its power spectrum
+    void autocorrelate() {
+        std::size_t count = envelope.size();
+
+        // Zero padding to twice the length keeps the circular correlation from wrapping around
+        int n = 1;
+        while ((std::size_t) n < 2 * count) n <<= 1;
+        const RealFFT &plan = RealFFT::get(n);
+
+        envelope.resize(n, 0.0);
+        spectrum.resize(plan.bins());
+        plan.forward(envelope.data(), spectrum.data());
+        for (auto &x: spectrum) x = std::norm(x);
+
+        correlation.resize(n);
+        plan.inverse(spectrum.data(), correlation.data());
+        envelope.resize(count);
+        correlation.resize(count);
+    }
+
+public:
+    /**
+     * @param center Most likely tempo in bpm, estimates are weighted by a log normal prior around it
+     * @param spread Standard deviation of the prior in octaves
+     * @param tightness Penalty for beat intervals that differ from the estimated period
+     */
+    explicit TempoEstimator(double center = 120, double spread = 1.0, double min_bpm = 40, double max_bpm = 240,
+                            double tightness = 100)
+            : center(center), spread(spread), min_bpm(min_bpm), max_bpm(max_bpm), tightness(tightness) {}
+
+    Beats estimate(const Onsets &onsets) {
+        Beats result;
+
+        std::size_t count = onsets.envelope.size();
+        double rate = onsets.rate;
+        if (count < 4 || rate <= 0) return result;
+
+        // Zero mean, unit deviation so that the transition penalty weighs the same for every song
+        envelope.assign(onsets.envelope.begin(), onsets.envelope.end());
+        double mean = 0, deviation = 0;
+        for (double x: envelope) mean += x;
+        mean /= (double) count;
+        for (double x: envelope) deviation += (x - mean) * (x - mean);
+        deviation = std::sqrt(deviation / (double) count);
+        if (deviation <= 0) return result;
+        for (auto &x: envelope) x = (x - mean) / deviation;
+
+        autocorrelate();
+
+        int low = std::max(1, (int) std::floor(60 * rate / max_bpm));
+        int high = std::min((int) count - 2, (int) std::ceil(60 * rate / min_bpm));
+        if (low >= high) return result;
+
+        auto weight = [&](double lag) {
+            double octaves = std::log2(60 * rate / lag / center) / spread;
+            return std::exp(-0.5 * octaves * octaves);
+        };
+
+        int best = low;
+        for (int lag = low; lag <= high; lag++) {
+            if (correlation[lag] * weight(lag) > correlation[best] * weight(best)) best = lag;
+        }
+
+        // Sub-frame period from a parabola through the neighbouring lags
+        double a = correlation[best - 1], b = correlation[best], c = correlation[best + 1];
+        double curve = a - 2 * b + c;
+        double period = best + (curve < 0 ? std::clamp(0.5 * (a - c) / curve, -0.5, 0.5) : 0.0);
+
+        result.period = period / rate;
+        result.bpm = 60 / result.period;
+
+        // score[t] is the best sum of onset strengths of a beat sequence ending at frame t
+        score.assign(count, 0.0);
+        previous.assign(count, -1);
+        int from = (int) std::round(2 * period), to = std::max(1, (int) std::round(period / 2));
+        for (int t = 0; t < (int) count; t++) {
+            double top = 0;
+            for (int before = std::max(0, t - from); before <= t - to; before++) {
+                double interval = std::log((t - before) / period);
+                double value = score[before] - tightness * interval * interval;
+                if (previous[t] < 0 || value > top) top = value, previous[t] = before;
+            }
+            score[t] = envelope[t] + std::max(top, 0.0);
+            if (top <= 0) previous[t] = -1;
+        }
+
+        // The last beat is the best scoring frame within the final period
+        int last = (int) count - 1;
+        for (int t = std::max(0, (int) count - 1 - (int) std::round(period)); t < (int) count; t++) {
+            if (score[t] > score[last]) last = t;
+        }
+
+        for (int t = last; t >= 0; t = previous[t]) result.beats.push_back(onsets.time(t));
+        std::reverse(result.beats.begin(), result.beats.end());
+        result.phase = result.beats.front();
+
+        return result;
+    }
+};
+
+#endif // TEMPO_H
@@ -0,0 +1,128 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running index based loops. The calling thread takes part as worker 0.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex lock, busy;
+    std::condition_variable wake, done;
+
+    std::function<void(std::size_t, std::size_t)> job;
+    std::size_t count = 0;
+    std::atomic<std::size_t> next = 0;
+    std::size_t active = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    std::exception_ptr error;
+
+    void run(std::size_t worker) {
+        for (std::size_t i; (i = next.fetch_add(1)) < count;) {
+            try {
+                job(i, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error) error = std::current_exception();
+                next = count;
+            }
+        }
+    }
+
+    void loop(std::size_t worker) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+
+            run(worker);
+
+            std::lock_guard<std::mutex> guard(lock);
+            if (--active == 0) done.notify_one();
+        }
+    }
+
+public:
+    /**
+     * @param threads Number of threads working on a loop, including the caller
+     */
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency()) {
+        threads = std::max<std::size_t>(threads, 1);
+        for (std::size_t i = 1; i < threads; i++) workers.emplace_back(&ThreadPool::loop, this, i);
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker: workers) worker.join();
+    }
+
+    /**
+     * @return Pool sized to the hardware concurrency
+     */
+    static ThreadPool &shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return workers.size() + 1;
+    }
+
+    /**
+     * Call f(index, worker) for every index in [0, count) and wait for all of them. Indices are handed out
+     * dynamically, worker is in [0, size()) and identifies the thread so that it can own scratch buffers.
+     */
+    void parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)> &f) {
+        std::lock_guard<std::mutex> serial(busy);
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            job = f;
+            this->count = count;
+            next = 0;
+            active = workers.size();
+            error = nullptr;
+            generation++;
+        }
+        wake.notify_all();
+
+        run(0);
+
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [&] { return active == 0; });
+        job = nullptr;
+
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,53 @@
+//
+// Created by 김준용 on 2026-10-17.
+//
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest value from one writer thread to one reader thread without locks. The writer fills its own slot and
+// publishes it by swapping it with the shared middle slot, the reader takes the middle slot whenever it is newer than
+// its own. Neither side ever waits, values the reader was too slow to see are dropped.
+template<typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t INDEX = 3, FRESH = 4;
+
+    T slots[3];
+    std::atomic<uint8_t> middle = 1; // Slot index, with FRESH set while the reader has not taken it
+    uint8_t back = 0, front = 2;
+
+public:
+    /**
+     * Writer side.
+     * @return Slot to fill before publish(), it keeps whatever was written to it two publishes ago
+     */
+    T &write() {
+        return slots[back];
+    }
+
+    /**
+     * Writer side, make the slot returned by write() the latest value
+     */
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /**
+     * Reader side.
+     * @return Latest published value, which stays valid and untouched until the next call
+     */
+    T &read() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        }
+        return slots[front];
+    }
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -7,13 +7,21 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <cstdint>
 #include <cassert>
+#include <cstring>
 #include <fstream>
-#include <utility>
+#include <memory>
+#include <span>
 #include <vector>
 
+#include "aligned.h"
+#include "mapped_file.h"
+#include "pcm.h"
+#include "riff.h"
+
 class Audio {
 protected:
 #pragma pack(push, 1) // 44 Byte 이므로 안 붙여도 상관은 없음
@@ -35,49 +43,67 @@ protected:
 #pragma pack(pop)
 
 private:
-    std::vector<std::pair<int16_t, int16_t>> data;
+    // Samples of a loaded file stay in the mapping until a channel is requested
+    std::shared_ptr<const MappedFile> file;
+    std::span<const uint8_t> pcm;
 
-    std::vector<uint8_t> sub_header;
+    PCM::Encoding encoding_ = PCM::Encoding::INT16;
+    std::size_t frames = 0;
 
-public:
-    Audio() = default;
+    // Planar storage, one aligned float array per channel spaced stride samples apart
+    mutable aligned_vector<float> planar;
+    mutable bool decoded = false;
+    std::size_t stride = 0;
+    bool edited = false;
 
-    explicit Audio(const std::string &path) {
-        std::ifstream in(path, std::iostream::binary);
-        if (!in) {
-            throw std::runtime_error("Can't open the file " + path);
-        }
-        in.read((char *) &header, 36);
+    // LIST, smpl, cue and other chunks carried over to write() untouched
+    std::vector<uint8_t> extra;
 
-        sub_header.resize(4);
-        for (int i = 0; i < 4; i++) in.read((char *) &sub_header[i], 1);
-        while (!(sub_header[sub_header.size() - 1] == 'a' && sub_header[sub_header.size() - 2] == 't' && sub_header[sub_header.size() - 3] == 'a' && sub_header[sub_header.size() - 4] == 'd')) {
-            sub_header.push_back(0);
-            in.read((char *) &sub_header.back(), 1);
-        }
-        in.read((char *) &header.Subchunk2Size, 4);
+    void decode() const {
+        if (decoded) return;
+        planar.resize(header.channels * stride);
 
-        uint32_t size = header.Subchunk2Size / (header.channels * (header.bits_per_sample / 8));
+        std::vector<float *> channels(header.channels);
+        for (int c = 0; c < header.channels; c++) channels[c] = planar.data() + c * stride;
+        PCM::deinterleave(pcm.data(), encoding_, header.channels, frames, channels.data());
 
-        // https://stackoverflow.com/questions/63929283/what-is-a-list-chunk-in-a-riff-wav-header
-        // Todo. fix LIST header
+        decoded = true;
+    }
 
-        data.resize(size);
-        for (int i = 0; i < size; i++) {
-            in.read((char *) &data[i].first, sizeof(int16_t));
-            in.read((char *) &data[i].second, sizeof(int16_t));
+    void check(uint16_t c) const {
+        if (c >= header.channels) { // Index out
+            throw std::runtime_error("Expected channel between 0 and " + std::to_string(header.channels - 1)
+                                     + ", but found " + std::to_string(c) + "!");
         }
-        in.close();
+    }
+
+public:
+    Audio() = default;
+
+    explicit Audio(const std::string &path) : file(std::make_shared<const MappedFile>(path)) {
+        Riff::Index index;
+        try {
+            index = Riff::parse(file->data(), file->size());
+            read_format(index, file->data());
+        } catch (std::runtime_error &e) {
+            throw std::runtime_error(std::string(e.what()) + " in " + path);
+        }
+
+        frames = index.data.size / header.block_align;
+        stride = aligned_size<float>(frames);
+        pcm = {file->data() + index.data.offset, frames * header.block_align};
     }
 
     // ms
     explicit Audio(uint32_t length) {
-        auto size = uint32_t((int64_t) header.sample_rate * length / 1000);
+        frames = std::size_t((int64_t) header.sample_rate * length / 1000);
+        stride = aligned_size<float>(frames);
 
-        header.Subchunk2Size = size * (header.channels * (header.bits_per_sample / 8));
+        header.Subchunk2Size = uint32_t(frames * header.block_align);
         header.chunk_size = 36 + header.Subchunk2Size;
 
-        data.resize(size, {0, 0});
+        planar.assign(header.channels * stride, 0.0f);
+        decoded = edited = true;
     }
 
     void write(const std::string &path) {
@@ -86,79 +112,174 @@ public:
             throw std::runtime_error("Can't open the file " + path);
         }
 
-        // Check header
-        uint32_t size = data.size();
+        // Edited samples are encoded back into the format of the header, untouched ones are copied as they are
+        std::vector<uint8_t> encoded;
+        std::span<const uint8_t> data = pcm;
+        if (edited) {
+            std::vector<const float *> channels(header.channels);
+            for (int c = 0; c < header.channels; c++) channels[c] = planar.data() + c * stride;
 
-        header.Subchunk2Size = size * (header.channels * (header.bits_per_sample / 8));
-        header.chunk_size = 36 + sub_header.size() + header.Subchunk2Size;
+            encoded.resize(frames * header.block_align);
+            PCM::interleave(channels.data(), encoding_, header.channels, frames, encoded.data());
+            data = encoded;
+        }
 
-        out.write((char *) &header, (sub_header.empty() ? 40 : 36));
-        if (!sub_header.empty()) out.write((char *) sub_header.data(), (int) sub_header.size());
-        out.write((char *) &header.Subchunk2Size, 4);
+        // Check header
+        header.Subchunk1Size = 16;
+        header.Subchunk2Size = (uint32_t) data.size();
+        header.chunk_size = uint32_t(4 + Riff::span(16) + extra.size() + Riff::span(header.Subchunk2Size));
 
-        for (auto &[a, b]: data) {
-            out.write((char *) &a, sizeof(int16_t));
-            out.write((char *) &b, sizeof(int16_t));
-        }
+        out.write((char *) &header, 12);
+        Riff::write(out, "fmt ", &header.audio_format, 16);
+        out.write((const char *) extra.data(), (std::streamsize) extra.size());
+        Riff::write(out, "data", data.data(), header.Subchunk2Size);
 
         out.close();
     }
 
-    std::pair<int16_t, int16_t> &operator[](int x) {
-        if (x >= data.size()) { // Index out
-            throw std::runtime_error("Expected value between 0 and " + std::to_string(data.size() - 1)
-                                     + ", but found " + std::to_string(x) + "!");
+    /**
+     * @return Samples of one channel normalized to [-1, 1)
+     */
+    [[nodiscard]] std::span<const float> channel(uint16_t c) const {
+        check(c);
+        decode();
+        return {planar.data() + c * stride, frames};
+    }
+
+    /**
+     * @return Writable samples of one channel, which are encoded again by write()
+     */
+    std::span<float> edit(uint16_t c) {
+        check(c);
+        decode();
+        edited = true;
+        return {planar.data() + c * stride, frames};
+    }
+
+    /**
+     * Average the channels of frames [begin, begin + count) into dst in one pass over the samples.
+     * @param window Per frame weights, or nullptr for a rectangular window
+     */
+    void mono(std::size_t begin, std::size_t count, const float *window, float *dst) const {
+        if (!edited) {
+            PCM::mono(pcm.data() + begin * header.block_align, encoding_, header.channels, count, window, dst);
+            return;
+        }
+
+        float scale = 1.0f / float(header.channels);
+        for (std::size_t i = 0; i < count; i++) {
+            float sum = 0;
+            for (int c = 0; c < header.channels; c++) sum += planar[c * stride + begin + i];
+            dst[i] = sum * scale * (window ? window[i] : 1.0f);
         }
-        return data[x];
     }
 
     /**
      * @return Size of data file
      */
-    std::size_t size() {
-        return data.size();
+    [[nodiscard]] std::size_t size() const {
+        return frames;
     }
 
-    void push_back(const std::pair<int16_t, int16_t> &a) {
-        data.push_back(a);
+    /**
+     * @return Read-only view of the interleaved data chunk as stored in the file
+     */
+    [[nodiscard]] std::span<const uint8_t> raw() const {
+        return pcm;
     }
 
     /**
      * @return Length of wav file in ms
      */
-    uint32_t length() {
-        return data.size() * 1000 / header.sample_rate;
+    [[nodiscard]] uint32_t length() const {
+        return uint32_t(uint64_t(size()) * 1000 / header.sample_rate);
+    }
+
+    [[nodiscard]] uint16_t channels() const {
+        return header.channels;
+    }
+
+    [[nodiscard]] uint16_t bits_per_sample() const {
+        return header.bits_per_sample;
+    }
+
+    [[nodiscard]] PCM::Encoding encoding() const {
+        return encoding_;
     }
 
     [[nodiscard]] uint32_t sample_rate() const {
         return header.sample_rate;
     }
 
-    static char *load(const std::string &path, int &channel, int &samplerate, int &bps, int &size) {
-        std::ifstream in(path, std::ios::binary);
-        Header header;
+    // Layout of the samples described by a fmt chunk
+    struct Format {
+        uint16_t channels = 0;
+        uint32_t sample_rate = 0;
+        uint16_t block_align = 0; // Bytes per frame
+        PCM::Encoding encoding = PCM::Encoding::INT16;
+    };
 
-        in.read((char *) &header, 36);
+    /**
+     * Read the fmt chunk of a file that is streamed rather than mapped
+     */
+    static Format read_format(std::istream &in, const Riff::Index &index) {
+        uint8_t fmt[40] = {};
+        uint32_t size = std::min<uint32_t>(index.fmt.size, sizeof(fmt));
+        in.clear();
+        in.seekg((std::streamoff) index.fmt.offset);
+        if (!in.read((char *) fmt, size)) throw std::runtime_error("Truncated fmt chunk");
 
-        std::vector<char> sub_header(4);
-        for (int i = 0; i < 4; i++) in.read((char *) &sub_header[i], 1);
-        while (!(sub_header[sub_header.size() - 1] == 'a' && sub_header[sub_header.size() - 2] == 't' && sub_header[sub_header.size() - 3] == 'a' && sub_header[sub_header.size() - 4] == 'd')) {
-            sub_header.push_back(0);
-            in.read((char *) &sub_header.back(), 1);
-        }
-        in.read((char *) &header.Subchunk2Size, 4);
+        Header header;
+        PCM::Encoding encoding = parse_format(fmt, size, header);
+        return {header.channels, header.sample_rate, header.block_align, encoding};
+    }
 
-        channel = header.channels;
-        samplerate = header.sample_rate;
-        bps = header.bits_per_sample;
-        size = header.Subchunk2Size;
+    static std::vector<char> load(const std::string &path, Format &format) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Can't open the file " + path);
+        }
+        Riff::Index index = Riff::parse(in);
+        format = read_format(in, index);
 
-        char *data = new char[size];
+        std::vector<char> data(index.data.size / format.block_align * format.block_align);
 
-        in.read(data, size);
+        in.seekg((std::streamoff) index.data.offset);
+        in.read(data.data(), (std::streamsize) data.size());
 
         return data;
     }
+
+private:
+    // Fill the fields of header from the payload of a fmt chunk and check that the samples can be decoded
+    static PCM::Encoding parse_format(const uint8_t *fmt, uint32_t size, Header &out) {
+        std::memcpy(&out.audio_format, fmt, 16);
+
+        // WAVE_FORMAT_EXTENSIBLE keeps the actual format tag in the first bytes of the sub format GUID
+        if (out.audio_format == PCM::WAVE_FORMAT_EXTENSIBLE && size >= 26) {
+            std::memcpy(&out.audio_format, fmt + 24, 2);
+        }
+        PCM::Encoding encoding = PCM::encoding(out.audio_format, out.bits_per_sample);
+
+        if (out.channels == 0 || out.block_align != out.channels * PCM::bytes(encoding)) {
+            throw std::runtime_error("Invalid block align " + std::to_string(out.block_align));
+        }
+        return encoding;
+    }
+
+    // Fill the header from the fmt chunk and keep the chunks that are neither fmt nor data
+    void read_format(const Riff::Index &index, const uint8_t *bytes) {
+        std::memcpy(header.chunk, bytes, 12);
+        header.Subchunk2Size = index.data.size;
+        encoding_ = parse_format(bytes + index.fmt.offset, index.fmt.size, header);
+
+        extra.clear();
+        for (auto &chunk: index.chunks) {
+            if (chunk.is("fmt ") || chunk.is("data")) continue;
+            const uint8_t *begin = bytes + chunk.offset - 8;
+            extra.insert(extra.end(), begin, begin + std::min(Riff::span(chunk.size), index.size - chunk.offset + 8));
+        }
+    }
 };
 
 #endif // WAV_H